@@ -4,7 +4,18 @@
  * - sem argumentos: modo interativo (menu)
  * - com 1 argumento: trata o argumento como arquivo de entrada (ex: entrada.txt)
  *   - arquivo deve ter 3 linhas: operacao (ex: +, -, *, /, %, m), numero1, numero2
- *   - saída será escrita em "resultado.txt" (um único número, dependendo da operação)
+ *   - o arquivo pode repetir esse bloco várias vezes (um resultado por linha)
+ *   - S (somatório) e P (produtório): um número por linha após a op, até linha em branco
+ *   - X (produto de matrizes): linha "r k c", depois as entradas de A (r x k) e de B (k x c)
+ *   - bit a bit (complemento de dois): &, |, ^, ~ (só numero1), << e >> (numero2 = bits)
+ *   - saída será escrita em "resultado.txt" (um número por registro)
+ * - números aceitam prefixos 0x (hex), 0o (octal) e 0b (binário), ex: -0xff
+ * - flags --hex, --oct, --bin, --dec escolhem a base da saída (padrão decimal)
+ * - +, -, *, /, %, m passam por um cache LRU de resultados: --no-cache desliga,
+ *   --cache-mb=N define o orçamento (padrão 64) e --cache-stats mostra acertos/falhas
+ * - ? (só numero1): 1 se primo (BPSW + Miller–Rabin), 0 caso contrário
+ * - F (só numero1): fatoração "2^3 * 5 * ..." por divisão por primos pequenos e
+ *   Pollard-rho (Brent, caminhadas em paralelo); --rho-iters=N limita os passos
  *
  */
 
@@ -12,6 +23,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 /* ------------------ bigint.h (conteúdo embutido) ------------------ */
 
@@ -51,9 +67,56 @@ BigInt *bigint_shift_blocks(const BigInt *a, size_t shift);
 /* gcd */
 BigInt *bigint_gcd(const BigInt *a, const BigInt *b);
 
+/* Bases potência de dois (2, 8, 16): prefixos 0b, 0o, 0x.
+   Radix 10 cai no caminho decimal normal. */
+BigInt *bigint_from_string_radix(const char *s, int radix);
+char *bigint_to_string_radix(const BigInt *a, int radix);
+
+/* Operações bit a bit com semântica de complemento de dois para negativos
+   (como se o sinal se estendesse infinitamente à esquerda).
+   shl: a * 2^k, shr: floor(a / 2^k). */
+BigInt *bigint_and(const BigInt *a, const BigInt *b);
+BigInt *bigint_or(const BigInt *a, const BigInt *b);
+BigInt *bigint_xor(const BigInt *a, const BigInt *b);
+BigInt *bigint_not(const BigInt *a);
+BigInt *bigint_shl(const BigInt *a, size_t k);
+BigInt *bigint_shr(const BigInt *a, size_t k);
+
+/* Cache de resultados (LRU com orçamento de memória) na frente de
+   add/sub/mul/divmod/gcd. Ligado por padrão; as variantes _cached devolvem
+   cópias próprias do resultado (o chamador libera como de costume). */
+void bigint_cache_config(int enabled, size_t budget_bytes);
+void bigint_cache_stats(unsigned long long *hits, unsigned long long *misses, size_t *bytes);
+void bigint_cache_clear(void);
+BigInt *bigint_add_cached(const BigInt *a, const BigInt *b);
+BigInt *bigint_sub_cached(const BigInt *a, const BigInt *b);
+BigInt *bigint_mul_cached(const BigInt *a, const BigInt *b);
+void bigint_divmod_cached(const BigInt *a, const BigInt *b, BigInt **q, BigInt **r);
+BigInt *bigint_gcd_cached(const BigInt *a, const BigInt *b);
+
+/* Reduções de listas: soma com carry adiado e produto em árvore balanceada.
+   xs não é modificado. Lista vazia: soma 0, produto 1. */
+BigInt *bigint_sum(BigInt *const *xs, size_t n);
+BigInt *bigint_product(BigInt *const *xs, size_t n);
+
+/* Produto de matrizes: A é r x k, B é k x c, todas em ordem de linha.
+   Retorna um array r*c de BigInt* (liberar cada um e depois o array). */
+BigInt **bigint_matmul(BigInt *const *A, BigInt *const *B, size_t r, size_t k, size_t c);
+
+/* Primalidade: BPSW (Miller–Rabin base 2 + Lucas forte) com rounds rodadas
+   extras de Miller–Rabin. Retorna 1 para primo (provável), 0 caso contrário.
+   Fatoração: fatores primos de |n| em ordem crescente (com repetição) em
+   *factors (liberar cada um e o array); *rest recebe o produto dos
+   compostos que o Pollard-rho não quebrou em rho_iters passos (ou NULL).
+   Retorna 0 em sucesso, -1 em erro. */
+int bigint_is_prime(const BigInt *n, int rounds);
+int bigint_factor(const BigInt *n, unsigned long long rho_iters,
+                  BigInt ***factors, size_t *count, BigInt **rest);
+
 /* IO */
 BigInt *read_bigint_stdin(void);
 int write_bigint_to_file(const char *path, const BigInt *res);
+int write_bigint_to_file_radix(const char *path, const BigInt *res, int radix);
 
 /* ------------------ bigint.c (implementação embutida) ------------------ */
 
@@ -68,6 +131,14 @@ BigInt *bigint_from_string(const char *s) {
         s++;
     }
 
+    /* prefixo de base: 0x, 0o, 0b -> parser de bases potência de dois */
+    if (s[0] == '0' && s[1] != '\0' && strchr("xXoObB", s[1])) {
+        int radix = (s[1] == 'x' || s[1] == 'X') ? 16 : (s[1] == 'o' || s[1] == 'O') ? 8 : 2;
+        BigInt *r = bigint_from_string_radix(s, radix);
+        if (r && !(r->len == 1 && r->data[0] == 0)) r->sign = sign;
+        return r;
+    }
+
     while (*s == '0') s++;  /* tira zeros à esquerda */
 
     size_t slen = strlen(s);
@@ -474,168 +545,2629 @@ BigInt *bigint_gcd(const BigInt *a, const BigInt *b) {
     return A;
 }
 
-/* ------------------ io.c (implementação embutida) ------------------ */
+/* ------------------ radix.c (bases 2, 8, 16) ------------------ */
+
+/* Os blocos internos são decimais (base 1e9), então hex/octal/binário passam
+   por uma representação intermediária em palavras de 32 bits (base 2^32,
+   little-endian). Texto <-> palavras é linear (cada dígito vira bits fixos),
+   mas palavras <-> blocos é uma troca de base de verdade: uma varredura de
+   multiplica-soma / divisão curta sobre todos os blocos por palavra, ou seja,
+   Θ(n^2). Para números de centenas de milhares de dígitos isso já custa
+   segundos; uma conversão subquadrática (dividir e conquistar sobre uma
+   multiplicação rápida) ainda não existe aqui. */
+
+/* bits por dígito de cada base potência de dois (0 = base não suportada) */
+static int radix_bits(int radix) {
+    if (radix == 2) return 1;
+    if (radix == 8) return 3;
+    if (radix == 16) return 4;
+    return 0;
+}
 
-BigInt *read_bigint_stdin(void) {
-    char buf[10005];
-    if (!fgets(buf, sizeof(buf), stdin)) return NULL;
-    size_t l = strlen(buf);
-    if (l && buf[l-1] == '\n') buf[l-1] = '\0';
-    return bigint_from_string(buf);
+/* palavras base 2^32 -> BigInt. w não é modificado. */
+static BigInt *bigint_from_words(const unsigned int *w, size_t n, int sign) {
+    while (n > 0 && w[n - 1] == 0) n--;
+
+    /* 32 bits ~ 9.64 dígitos decimais ~ 1.07 blocos por palavra */
+    BigInt *res = bigint_new(n + n / 8 + 2, sign);
+    if (!res) return NULL;
+
+    size_t used = 1;
+    for (size_t i = n; i-- > 0;) {
+        /* res = res * 2^32 + w[i] */
+        unsigned long long carry = w[i];
+        for (size_t j = 0; j < used; ++j) {
+            unsigned long long cur = ((unsigned long long)res->data[j] << 32) + carry;
+            res->data[j] = (unsigned int)(cur % BASE);
+            carry = cur / BASE;
+        }
+        while (carry) {
+            res->data[used++] = (unsigned int)(carry % BASE);
+            carry /= BASE;
+        }
+    }
+    res->len = used;
+    bigint_normalize(res);
+    return res;
 }
 
-int write_bigint_to_file(const char *path, const BigInt *res) {
-    char *s = bigint_to_string(res);
-    FILE *f = fopen(path, "w");
-    if (!f) { free(s); return -1; }
-    fprintf(f, "%s\n", s);
-    fclose(f);
-    free(s);
-    return 0;
+/* |a| -> palavras base 2^32. *nwords recebe o número de palavras
+   significativas (0 para zero). O array retornado deve ser liberado com free. */
+static unsigned int *bigint_to_words(const BigInt *a, size_t *nwords) {
+    /* cada bloco tem < 30 bits, então len palavras sempre bastam */
+    unsigned int *w = malloc((a->len + 1) * sizeof(unsigned int));
+    unsigned int *tmp = malloc(a->len * sizeof(unsigned int));
+    if (!w || !tmp) { free(w); free(tmp); return NULL; }
+    memcpy(tmp, a->data, a->len * sizeof(unsigned int));
+
+    size_t tlen = a->len;
+    size_t n = 0;
+    while (tlen > 0 && tmp[tlen - 1] == 0) tlen--;
+    while (tlen > 0) {
+        /* divisão curta por 2^32: o resto é a próxima palavra */
+        unsigned long long rem = 0;
+        for (size_t i = tlen; i-- > 0;) {
+            unsigned long long cur = rem * BASE + tmp[i];
+            tmp[i] = (unsigned int)(cur >> 32);
+            rem = cur & 0xFFFFFFFFull;
+        }
+        w[n++] = (unsigned int)rem;
+        while (tlen > 0 && tmp[tlen - 1] == 0) tlen--;
+    }
+    free(tmp);
+    *nwords = n;
+    return w;
 }
 
-/* ------------------ main.c (embutido) ------------------ */
+/* aceita [+-][prefixo]dígitos; o prefixo, se presente, precisa casar com radix.
+   Retorna NULL para dígito inválido. */
+BigInt *bigint_from_string_radix(const char *s, int radix) {
+    if (!s) return NULL;
+    if (radix == 10) return bigint_from_string(s);
+    int bits = radix_bits(radix);
+    if (!bits) return NULL;
 
-static void print_menu(void) {
-    printf("=== CalcBigInt ===\n");
-    printf("1) Soma (+)\n");
-    printf("2) Subtracao (-)\n");
-    printf("3) Multiplicacao (*)\n");
-    printf("4) Divisao inteira (/)\n");
-    printf("5) Modulo (%%)\n");
-    printf("6) MDC\n");
-    printf("7) Sair\n");
-    printf("Escolha: ");
+    while (*s && isspace((unsigned char)*s)) s++;
+
+    int sign = 1;
+    if (*s == '+' || *s == '-') {
+        if (*s == '-') sign = -1;
+        s++;
+    }
+
+    if (s[0] == '0') {
+        char p = (char)tolower((unsigned char)s[1]);
+        if ((radix == 16 && p == 'x') || (radix == 8 && p == 'o') || (radix == 2 && p == 'b'))
+            s += 2;
+    }
+
+    while (*s == '0') s++;
+
+    size_t ndig = 0;
+    while (s[ndig] && !isspace((unsigned char)s[ndig])) ndig++;
+    for (const char *t = s + ndig; *t; ++t)
+        if (!isspace((unsigned char)*t)) return NULL;
+
+    size_t nwords = (ndig * (size_t)bits) / 32 + 1;
+    unsigned int *w = calloc(nwords, sizeof(unsigned int));
+    if (!w) return NULL;
+
+    /* do dígito menos significativo para o mais significativo */
+    size_t bitpos = 0;
+    for (size_t i = ndig; i-- > 0;) {
+        int c = (unsigned char)s[i];
+        int v;
+        if (c >= '0' && c <= '9') v = c - '0';
+        else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') v = c - 'A' + 10;
+        else v = radix;
+        if (v >= radix) { free(w); return NULL; }
+
+        size_t wi = bitpos / 32;
+        unsigned int sh = (unsigned int)(bitpos % 32);
+        w[wi] |= (unsigned int)v << sh;
+        if (sh + (unsigned int)bits > 32)  /* dígito octal atravessando palavras */
+            w[wi + 1] |= (unsigned int)v >> (32 - sh);
+        bitpos += (size_t)bits;
+    }
+
+    BigInt *res = bigint_from_words(w, nwords, sign);
+    free(w);
+    return res;
 }
 
-/* lê arquivo de entrada com 3 linhas: op, a, b
-   retorna op char em *op_out e BigInt* em a_out, b_out (callees deve liberar)
-   retorna 0 em sucesso, -1 em erro.
-*/
-static int read_from_file_input(const char *fname, char *op_out, BigInt **a_out, BigInt **b_out) {
-    FILE *f = fopen(fname, "r");
-    if (!f) return -1;
-    char line[10010];
+char *bigint_to_string_radix(const BigInt *a, int radix) {
+    if (!a) return NULL;
+    if (radix == 10) return bigint_to_string(a);
+    int bits = radix_bits(radix);
+    if (!bits) return NULL;
+
+    size_t n = 0;
+    unsigned int *w = bigint_to_words(a, &n);
+    if (!w) return NULL;
+
+    size_t nbits = 0;
+    if (n > 0) {
+        unsigned int top = w[n - 1];
+        nbits = (n - 1) * 32;
+        while (top) { nbits++; top >>= 1; }
+    }
+    size_t ndig = nbits ? (nbits + (size_t)bits - 1) / (size_t)bits : 1;
 
-    /* linha 1: operação */
-    if (!fgets(line, sizeof(line), f)) { fclose(f); return -1; }
-    size_t l = strlen(line); if (l && line[l-1]=='\n') line[l-1]='\0';
-    
-    char *p = line;
-    while (*p && isspace((unsigned char)*p)) p++;
-    if (!*p) { fclose(f); return -1; }
-    char op = *p;
+    char *out = malloc(ndig + 4);  /* sinal + prefixo + '\0' */
+    if (!out) { free(w); return NULL; }
 
-    /* linha 2: a */
-    if (!fgets(line, sizeof(line), f)) { fclose(f); return -1; }
-    l = strlen(line); if (l && line[l-1]=='\n') line[l-1]='\0';
-    BigInt *a = bigint_from_string(line);
-    if (!a) { fclose(f); return -1; }
+    char *p = out;
+    if (a->sign < 0 && n > 0) *p++ = '-';
+    *p++ = '0';
+    *p++ = (radix == 16) ? 'x' : (radix == 8) ? 'o' : 'b';
+
+    static const char digits[] = "0123456789abcdef";
+    unsigned int mask = (unsigned int)radix - 1;
+    for (size_t d = ndig; d-- > 0;) {
+        size_t bitpos = d * (size_t)bits;
+        size_t wi = bitpos / 32;
+        unsigned int sh = (unsigned int)(bitpos % 32);
+        unsigned int v = (wi < n) ? (w[wi] >> sh) : 0;
+        if (sh + (unsigned int)bits > 32 && wi + 1 < n)
+            v |= w[wi + 1] << (32 - sh);
+        *p++ = digits[v & mask];
+    }
+    *p = '\0';
+    free(w);
+    return out;
+}
 
-    /* linha 3: b */
-    if (!fgets(line, sizeof(line), f)) { bigint_free(a); fclose(f); return -1; }
-    l = strlen(line); if (l && line[l-1]=='\n') line[l-1]='\0';
-    BigInt *b = bigint_from_string(line);
-    if (!b) { bigint_free(a); fclose(f); return -1; }
+/* ------------------ bitwise.c (AND/OR/XOR/NOT e shifts) ------------------ */
 
-    fclose(f);
-    *op_out = op;
-    *a_out = a;
-    *b_out = b;
+/* AND/OR/XOR trabalham sobre palavras de 32 bits em complemento de dois:
+   converte, aplica a operação num único passe e converte de volta. O passe é
+   linear, mas as conversões (radix.c) são Θ(n^2), então AND/OR/XOR custam
+   bem mais que uma soma em números grandes.
+   Shifts são feitos direto nos blocos decimais, até 29 bits por passe (já
+   que 2^29 < BASE): O(len * k / 29), o mesmo custo de uma multiplicação.
+   Só quando k / 29 passa de len é que compensa ir pelas palavras. */
+
+#define SHIFT_CHUNK 29
+
+/* x -> -x em complemento de dois (n palavras) */
+static void twos_negate(unsigned int *w, size_t n) {
+    unsigned long long carry = 1;
+    for (size_t i = 0; i < n; ++i) {
+        unsigned long long cur = (unsigned long long)(~w[i]) + carry;
+        w[i] = (unsigned int)cur;
+        carry = cur >> 32;
+    }
+}
+
+/* a em complemento de dois com exatamente n palavras (n > palavras de |a|) */
+static unsigned int *bigint_to_twos(const BigInt *a, size_t n) {
+    size_t m = 0;
+    unsigned int *w = bigint_to_words(a, &m);
+    if (!w) return NULL;
+    unsigned int *t = calloc(n, sizeof(unsigned int));
+    if (!t) { free(w); return NULL; }
+    memcpy(t, w, m * sizeof(unsigned int));
+    free(w);
+    if (a->sign < 0 && m > 0) twos_negate(t, n);
+    return t;
+}
+
+/* quantidade de palavras de 32 bits necessárias para |a| */
+static size_t bigint_word_count(const BigInt *a) {
+    /* cada bloco tem < 30 bits */
+    return (a->len * 30) / 32 + 1;
+}
+
+static BigInt *bigint_bitwise(const BigInt *a, const BigInt *b, char op) {
+    if (!a || !b) return NULL;
+
+    size_t na = bigint_word_count(a), nb = bigint_word_count(b);
+    size_t n = ((na > nb) ? na : nb) + 1;  /* +1 palavra para o sinal */
+
+    unsigned int *wa = bigint_to_twos(a, n);
+    unsigned int *wb = bigint_to_twos(b, n);
+    if (!wa || !wb) { free(wa); free(wb); return NULL; }
+
+    for (size_t i = 0; i < n; ++i) {
+        if (op == '&') wa[i] &= wb[i];
+        else if (op == '|') wa[i] |= wb[i];
+        else wa[i] ^= wb[i];
+    }
+    free(wb);
+
+    int neg = (wa[n - 1] >> 31) != 0;
+    if (neg) twos_negate(wa, n);
+
+    BigInt *res = bigint_from_words(wa, n, neg ? -1 : 1);
+    free(wa);
+    return res;
+}
+
+BigInt *bigint_and(const BigInt *a, const BigInt *b) { return bigint_bitwise(a, b, '&'); }
+BigInt *bigint_or(const BigInt *a, const BigInt *b)  { return bigint_bitwise(a, b, '|'); }
+BigInt *bigint_xor(const BigInt *a, const BigInt *b) { return bigint_bitwise(a, b, '^'); }
+
+/* ~a = -a - 1 */
+BigInt *bigint_not(const BigInt *a) {
+    if (!a) return NULL;
+    unsigned int one_data = 1;
+    BigInt one = { 1, 1, &one_data };
+    BigInt na = *a;
+    na.sign = -a->sign;
+    return bigint_sub(&na, &one);
+}
+
+/* shift de k bits em a pelos blocos (1) ou pelas palavras (0) */
+static int shift_native(const BigInt *a, size_t k) {
+    return k / SHIFT_CHUNK <= a->len;
+}
+
+/* converte a (>= 0) para size_t; -1 se negativo ou grande demais */
+static int bigint_to_size(const BigInt *a, size_t *out) {
+    if (!a || (a->sign < 0 && !bigint_is_zero(a))) return -1;
+    size_t v = 0;
+    for (size_t i = a->len; i-- > 0;) {
+        if (v > ((size_t)-1 - a->data[i]) / BASE) return -1;
+        v = v * BASE + a->data[i];
+    }
+    *out = v;
     return 0;
 }
 
-int main(int argc, char **argv) {
-    char line[64];
+BigInt *bigint_shl(const BigInt *a, size_t k) {
+    if (!a) return NULL;
 
-    /* comportamento: se argc == 2 -> modo arquivo. escreve "resultado.txt" */
-    if (argc == 2) {
-        const char *inputfile = argv[1];
-        const char *outputfile = "resultado.txt";
+    if (bigint_is_zero(a)) return bigint_from_uint(0);
 
-        char op;
-        BigInt *a = NULL, *b = NULL;
-        if (read_from_file_input(inputfile, &op, &a, &b) != 0) {
-            fprintf(stderr, "Erro lendo arquivo de entrada (%s)\n", inputfile);
-            return 1;
+    if (shift_native(a, k)) {
+        /* cada passe cresce no máximo 1 bloco */
+        BigInt *res = bigint_new(a->len + k / SHIFT_CHUNK + 1, a->sign);
+        if (!res) return NULL;
+        memcpy(res->data, a->data, a->len * sizeof(unsigned int));
+        size_t used = a->len;
+        while (k > 0) {
+            unsigned int sh = (k > SHIFT_CHUNK) ? SHIFT_CHUNK : (unsigned int)k;
+            k -= sh;
+            unsigned long long carry = 0;
+            for (size_t i = 0; i < used; ++i) {
+                unsigned long long cur = ((unsigned long long)res->data[i] << sh) + carry;
+                res->data[i] = (unsigned int)(cur % BASE);
+                carry = cur / BASE;
+            }
+            if (carry) res->data[used++] = (unsigned int)carry;
         }
+        res->len = used;
+        bigint_normalize(res);
+        return res;
+    }
 
-        BigInt *res_q = NULL, *res_r = NULL, *res = NULL;
-        if (op == '+') {
-            res = bigint_add(a, b);
-        } else if (op == '-') {
-            res = bigint_sub(a, b);
-        } else if (op == '*') {
-            res = bigint_mul(a, b);
-        } else if (op == '/') {
-            bigint_divmod(a, b, &res_q, &res_r);
-            /* para '/' escrevemos apenas o quociente */
-            if (res_q) {
-                write_bigint_to_file(outputfile, res_q);
-            } else {
-                fprintf(stderr, "Erro na divisao (divisor zero?).\n");
-                bigint_free(a); bigint_free(b);
-                if (res_q) bigint_free(res_q);
-                if (res_r) bigint_free(res_r);
-                return 1;
-            }
-            bigint_free(a); bigint_free(b);
-            if (res_q) bigint_free(res_q);
-            if (res_r) bigint_free(res_r);
-            printf("Resultado escrito em %s\n", outputfile);
-            return 0;
-        } else if (op == '%') {
-            bigint_divmod(a, b, &res_q, &res_r);
-            /* para '%' escrevemos apenas o resto */
-            if (res_r) {
-                write_bigint_to_file(outputfile, res_r);
-            } else {
-                fprintf(stderr, "Erro na operacao modulo (divisor zero?).\n");
-                bigint_free(a); bigint_free(b);
-                if (res_q) bigint_free(res_q);
-                if (res_r) bigint_free(res_r);
-                return 1;
-            }
-            bigint_free(a); bigint_free(b);
-            if (res_q) bigint_free(res_q);
-            if (res_r) bigint_free(res_r);
-            printf("Resultado escrito em %s\n", outputfile);
-            return 0;
-        } else if (op == 'm' || op == 'M') {
-            BigInt *g = bigint_gcd(a, b);
-            if (!g) {
-                fprintf(stderr, "Erro calculando MDC.\n");
-                bigint_free(a); bigint_free(b);
-                return 1;
-            }
-            if (write_bigint_to_file(outputfile, g) != 0) {
-                fprintf(stderr, "Erro escrevendo resultado em %s\n", outputfile);
-                bigint_free(g); bigint_free(a); bigint_free(b);
-                return 1;
+    size_t m = 0;
+    unsigned int *w = bigint_to_words(a, &m);
+    if (!w) return NULL;
+    size_t ws = k / 32;
+    unsigned int bs = (unsigned int)(k % 32);
+    size_t n = m + ws + 1;
+    unsigned int *out = calloc(n, sizeof(unsigned int));
+    if (!out) { free(w); return NULL; }
+    for (size_t i = 0; i < m; ++i) {
+        out[i + ws] |= w[i] << bs;
+        if (bs) out[i + ws + 1] |= w[i] >> (32 - bs);
+    }
+    free(w);
+    BigInt *res = bigint_from_words(out, n, a->sign);
+    free(out);
+    return res;
+}
+
+BigInt *bigint_shr(const BigInt *a, size_t k) {
+    if (!a) return NULL;
+
+    int lost = 0;  /* algum bit 1 saiu pela direita? (arredonda negativos para baixo) */
+    BigInt *res = NULL;
+
+    if (shift_native(a, k)) {
+        res = bigint_abs_copy(a);
+        if (!res) return NULL;
+        while (k > 0 && !bigint_is_zero(res)) {
+            unsigned int sh = (k > SHIFT_CHUNK) ? SHIFT_CHUNK : (unsigned int)k;
+            k -= sh;
+            unsigned long long rem = 0;
+            for (size_t i = res->len; i-- > 0;) {
+                unsigned long long cur = rem * BASE + res->data[i];
+                res->data[i] = (unsigned int)(cur >> sh);
+                rem = cur & ((1ull << sh) - 1);
             }
-            printf("Resultado escrito em %s\n", outputfile);
-            bigint_free(g); bigint_free(a); bigint_free(b);
-            return 0;
-        } else {
-            fprintf(stderr, "Operacao desconhecida: %c\n", op);
-            bigint_free(a); bigint_free(b);
-            return 1;
+            if (rem) lost = 1;
+            bigint_normalize(res);
+        }
+    } else {
+        size_t m = 0;
+        unsigned int *w = bigint_to_words(a, &m);
+        if (!w) return NULL;
+        size_t ws = k / 32;
+        unsigned int bs = (unsigned int)(k % 32);
+        size_t n = (m > ws) ? m - ws : 0;
+        for (size_t i = 0; i < m && i <= ws; ++i) {
+            if (i < ws ? w[i] != 0 : (bs && (w[i] & ((1u << bs) - 1)) != 0)) lost = 1;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            unsigned int v = w[i + ws] >> bs;
+            if (bs && i + ws + 1 < m) v |= w[i + ws + 1] << (32 - bs);
+            w[i] = v;
         }
+        res = bigint_from_words(w, n, 1);
+        free(w);
+        if (!res) return NULL;
+    }
 
-        if (!res) {
-            fprintf(stderr, "Erro na operacao.\n");
-            bigint_free(a); bigint_free(b);
-            return 1;
+    if (a->sign < 0) {
+        if (lost) {
+            unsigned int one_data = 1;
+            BigInt one = { 1, 1, &one_data };
+            BigInt *t = bigint_add(res, &one);
+            bigint_free(res);
+            res = t;
+            if (!res) return NULL;
         }
-        /* para + - * escrevemos resultado no arquivo */
-        if (write_bigint_to_file(outputfile, res) != 0) {
-            fprintf(stderr, "Erro escrevendo resultado em %s\n", outputfile);
-            bigint_free(res); bigint_free(a); bigint_free(b);
-            return 1;
+        res->sign = -1;
+        bigint_normalize(res);
+    }
+    return res;
+}
+
+/* ------------------ fixed.c (BigInt de largura fixa: 256..2048 bits) ------------------ */
+
+/* Tipos de valor na pilha para operandos do tamanho de criptografia.
+   Mesma representação do BigInt (blocos base 1e9, little-endian), mas com
+   N blocos fixos: N é o menor número de blocos que comporta qualquer
+   inteiro de BITS bits. Todas as larguras saem do mesmo macro, então cada
+   uma tem seus laços com limite constante (desenrolados pelo compilador).
+   Quem chama garante que o resultado cabe (veja bigint_fixed_try). */
+
+#if defined(__GNUC__)
+#define FIXED_UNROLL _Pragma("GCC unroll 72")
+#else
+#define FIXED_UNROLL
+#endif
+
+/* (BITS, N): N = ceil(BITS * log10(2) / 9) */
+#define BIGINT_FIXED_WIDTHS(X) \
+    X(256, 9)                  \
+    X(512, 18)                 \
+    X(1024, 35)                \
+    X(2048, 69)
+
+/* blocos -> BigInt novo (normalizado) */
+static BigInt *bigint_from_limbs(const unsigned int *d, size_t n, int sign) {
+    BigInt *r = bigint_new(n, sign);
+    if (!r) return NULL;
+    memcpy(r->data, d, n * sizeof(unsigned int));
+    bigint_normalize(r);
+    return r;
+}
+
+#define DEFINE_BIGINT_FIXED(BITS, N)                                                                                      \
+typedef struct {                                                                                                          \
+    int sign;                                                                                                             \
+    unsigned int d[N];                                                                                                    \
+} BigInt##BITS;                                                                                                           \
+                                                                                                                          \
+/* produto completo de dois BigInt##BITS */                                                                               \
+typedef struct {                                                                                                          \
+    int sign;                                                                                                             \
+    unsigned int d[2 * N];                                                                                                \
+} BigInt##BITS##_wide;                                                                                                    \
+                                                                                                                          \
+static inline int bigint##BITS##_load(BigInt##BITS *x, const BigInt *a) {                                                 \
+    if (a->len > N) return -1;                                                                                            \
+    memcpy(x->d, a->data, a->len * sizeof(unsigned int));                                                                 \
+    memset(x->d + a->len, 0, (N - a->len) * sizeof(unsigned int));                                                        \
+    x->sign = a->sign;                                                                                                    \
+    return 0;                                                                                                             \
+}                                                                                                                         \
+                                                                                                                          \
+static inline int bigint##BITS##_is_zero(const BigInt##BITS *a) {                                                         \
+    unsigned int acc = 0;                                                                                                 \
+    FIXED_UNROLL                                                                                                          \
+    for (int i = 0; i < N; ++i) acc |= a->d[i];                                                                           \
+    return acc == 0;                                                                                                      \
+}                                                                                                                         \
+                                                                                                                          \
+static inline int bigint##BITS##_cmpabs(const BigInt##BITS *a, const BigInt##BITS *b) {                                   \
+    for (int i = N - 1; i >= 0; --i) {                                                                                    \
+        if (a->d[i] != b->d[i]) return (a->d[i] < b->d[i]) ? -1 : 1;                                                      \
+    }                                                                                                                     \
+    return 0;                                                                                                             \
+}                                                                                                                         \
+                                                                                                                          \
+/* |r| = |a| + |b| */                                                                                                     \
+static inline void bigint##BITS##_add_abs(BigInt##BITS *r, const BigInt##BITS *a, const BigInt##BITS *b) {                \
+    unsigned int carry = 0;                                                                                               \
+    FIXED_UNROLL                                                                                                          \
+    for (int i = 0; i < N; ++i) {                                                                                         \
+        unsigned int s = a->d[i] + b->d[i] + carry;  /* < 2*BASE, cabe em 32 bits */                                      \
+        carry = (s >= BASE);                                                                                              \
+        r->d[i] = carry ? s - BASE : s;                                                                                   \
+    }                                                                                                                     \
+}                                                                                                                         \
+                                                                                                                          \
+/* |r| = |a| - |b|, assumindo |a| >= |b| */                                                                               \
+static inline void bigint##BITS##_sub_abs(BigInt##BITS *r, const BigInt##BITS *a, const BigInt##BITS *b) {                \
+    unsigned int borrow = 0;                                                                                              \
+    FIXED_UNROLL                                                                                                          \
+    for (int i = 0; i < N; ++i) {                                                                                         \
+        unsigned int bv = b->d[i] + borrow;                                                                               \
+        borrow = (a->d[i] < bv);                                                                                          \
+        r->d[i] = borrow ? a->d[i] + BASE - bv : a->d[i] - bv;                                                            \
+    }                                                                                                                     \
+}                                                                                                                         \
+                                                                                                                          \
+static inline void bigint##BITS##_add(BigInt##BITS *r, const BigInt##BITS *a, const BigInt##BITS *b) {                    \
+    if (a->sign == b->sign) {                                                                                             \
+        bigint##BITS##_add_abs(r, a, b);                                                                                  \
+        r->sign = a->sign;                                                                                                \
+    } else if (bigint##BITS##_cmpabs(a, b) >= 0) {                                                                        \
+        int s = a->sign;                                                                                                  \
+        bigint##BITS##_sub_abs(r, a, b);                                                                                  \
+        r->sign = s;                                                                                                      \
+    } else {                                                                                                              \
+        int s = b->sign;                                                                                                  \
+        bigint##BITS##_sub_abs(r, b, a);                                                                                  \
+        r->sign = s;                                                                                                      \
+    }                                                                                                                     \
+    if (bigint##BITS##_is_zero(r)) r->sign = 1;                                                                           \
+}                                                                                                                         \
+                                                                                                                          \
+static inline void bigint##BITS##_sub(BigInt##BITS *r, const BigInt##BITS *a, const BigInt##BITS *b) {                    \
+    BigInt##BITS nb = *b;                                                                                                 \
+    nb.sign = -b->sign;                                                                                                   \
+    bigint##BITS##_add(r, a, &nb);                                                                                        \
+}                                                                                                                         \
+                                                                                                                          \
+static inline void bigint##BITS##_mul(BigInt##BITS##_wide *r, const BigInt##BITS *a, const BigInt##BITS *b) {             \
+    memset(r->d, 0, sizeof(r->d));                                                                                        \
+    for (int i = 0; i < N; ++i) {                                                                                         \
+        unsigned long long ai = a->d[i];                                                                                  \
+        if (!ai) continue;                                                                                                \
+        unsigned long long carry = 0;                                                                                     \
+        FIXED_UNROLL                                                                                                      \
+        for (int j = 0; j < N; ++j) {                                                                                     \
+            unsigned long long cur = r->d[i + j] + ai * b->d[j] + carry;                                                  \
+            r->d[i + j] = (unsigned int)(cur % BASE);                                                                     \
+            carry = cur / BASE;                                                                                           \
+        }                                                                                                                 \
+        r->d[i + N] = (unsigned int)carry;                                                                                \
+    }                                                                                                                     \
+    r->sign = a->sign * b->sign;                                                                                          \
+    unsigned int acc = 0;                                                                                                 \
+    for (int i = 0; i < 2 * N; ++i) acc |= r->d[i];                                                                       \
+    if (!acc) r->sign = 1;                                                                                                \
+}                                                                                                                         \
+                                                                                                                          \
+/* q = a / b, r = a % b (truncado, como bigint_divmod). Divisão longa de                                                  \
+   Knuth (algoritmo D) em base 1e9, toda em arrays na pilha.                                                              \
+   Retorna -1 se b == 0. */                                                                                               \
+static inline int bigint##BITS##_divmod(BigInt##BITS *q, BigInt##BITS *r, const BigInt##BITS *a, const BigInt##BITS *b) { \
+    int n = N, m = N;                                                                                                     \
+    while (n > 0 && b->d[n - 1] == 0) n--;                                                                                \
+    if (n == 0) return -1;                                                                                                \
+    while (m > 0 && a->d[m - 1] == 0) m--;                                                                                \
+                                                                                                                          \
+    int qs = a->sign * b->sign, rs = a->sign;                                                                             \
+    memset(q->d, 0, sizeof(q->d));                                                                                        \
+                                                                                                                          \
+    if (m < n || bigint##BITS##_cmpabs(a, b) < 0) {                                                                       \
+        *r = *a;                                                                                                          \
+    } else if (n == 1) {                                                                                                  \
+        /* divisor de um bloco: divisão curta */                                                                          \
+        unsigned long long rem = 0, v = b->d[0];                                                                          \
+        for (int i = m - 1; i >= 0; --i) {                                                                                \
+            unsigned long long cur = rem * BASE + a->d[i];                                                                \
+            q->d[i] = (unsigned int)(cur / v);                                                                            \
+            rem = cur % v;                                                                                                \
+        }                                                                                                                 \
+        memset(r->d, 0, sizeof(r->d));                                                                                    \
+        r->d[0] = (unsigned int)rem;                                                                                      \
+    } else {                                                                                                              \
+        /* normaliza: v[n-1] >= BASE/2 para a estimativa de qhat errar por no máximo 2 */                                 \
+        unsigned int u[N + 1], v[N];                                                                                      \
+        unsigned long long f = BASE / ((unsigned long long)b->d[n - 1] + 1);                                              \
+        unsigned long long carry = 0;                                                                                     \
+        for (int i = 0; i < N; ++i) {                                                                                     \
+            unsigned long long cur = a->d[i] * f + carry;                                                                 \
+            u[i] = (unsigned int)(cur % BASE);                                                                            \
+            carry = cur / BASE;                                                                                           \
+        }                                                                                                                 \
+        u[N] = (unsigned int)carry;                                                                                       \
+        carry = 0;                                                                                                        \
+        for (int i = 0; i < N; ++i) {                                                                                     \
+            unsigned long long cur = b->d[i] * f + carry;                                                                 \
+            v[i] = (unsigned int)(cur % BASE);                                                                            \
+            carry = cur / BASE;                                                                                           \
+        }                                                                                                                 \
+                                                                                                                          \
+        for (int j = m - n; j >= 0; --j) {                                                                                \
+            unsigned long long num = (unsigned long long)u[j + n] * BASE + u[j + n - 1];                                  \
+            unsigned long long qhat = num / v[n - 1];                                                                     \
+            unsigned long long rhat = num % v[n - 1];                                                                     \
+            if (qhat >= BASE) {                                                                                           \
+                qhat = BASE - 1;                                                                                          \
+                rhat = num - qhat * v[n - 1];                                                                             \
+            }                                                                                                             \
+            while (rhat < BASE && qhat * v[n - 2] > rhat * BASE + u[j + n - 2]) {                                         \
+                qhat--;                                                                                                   \
+                rhat += v[n - 1];                                                                                         \
+            }                                                                                                             \
+                                                                                                                          \
+            /* u[j..j+n] -= qhat * v */                                                                                   \
+            unsigned long long mc = 0;                                                                                    \
+            long long borrow = 0;                                                                                         \
+            for (int i = 0; i < n; ++i) {                                                                                 \
+                unsigned long long p = qhat * v[i] + mc;                                                                  \
+                mc = p / BASE;                                                                                            \
+                long long t = (long long)u[i + j] - (long long)(p % BASE) - borrow;                                       \
+                borrow = (t < 0);                                                                                         \
+                u[i + j] = (unsigned int)(borrow ? t + BASE : t);                                                         \
+            }                                                                                                             \
+            long long top = (long long)u[j + n] - (long long)mc - borrow;                                                 \
+            if (top < 0) {                                                                                                \
+                /* qhat ficou 1 acima: soma v de volta */                                                                 \
+                qhat--;                                                                                                   \
+                unsigned long long c = 0;                                                                                 \
+                for (int i = 0; i < n; ++i) {                                                                             \
+                    unsigned long long s = (unsigned long long)u[i + j] + v[i] + c;                                       \
+                    u[i + j] = (unsigned int)(s % BASE);                                                                  \
+                    c = s / BASE;                                                                                         \
+                }                                                                                                         \
+                top += (long long)c;                                                                                      \
+            }                                                                                                             \
+            u[j + n] = (unsigned int)top;                                                                                 \
+            q->d[j] = (unsigned int)qhat;                                                                                 \
+        }                                                                                                                 \
+                                                                                                                          \
+        /* resto = u[0..n-1] / f */                                                                                       \
+        memset(r->d, 0, sizeof(r->d));                                                                                    \
+        unsigned long long rem = 0;                                                                                       \
+        for (int i = n - 1; i >= 0; --i) {                                                                                \
+            unsigned long long cur = rem * BASE + u[i];                                                                   \
+            r->d[i] = (unsigned int)(cur / f);                                                                            \
+            rem = cur % f;                                                                                                \
+        }                                                                                                                 \
+    }                                                                                                                     \
+                                                                                                                          \
+    q->sign = bigint##BITS##_is_zero(q) ? 1 : qs;                                                                         \
+    r->sign = bigint##BITS##_is_zero(r) ? 1 : rs;                                                                         \
+    return 0;                                                                                                             \
+}                                                                                                                         \
+                                                                                                                          \
+static inline void bigint##BITS##_gcd(BigInt##BITS *g, const BigInt##BITS *a, const BigInt##BITS *b) {                    \
+    BigInt##BITS x = *a, y = *b, q, t;                                                                                    \
+    x.sign = y.sign = 1;                                                                                                  \
+    while (!bigint##BITS##_is_zero(&y)) {                                                                                 \
+        bigint##BITS##_divmod(&q, &t, &x, &y);                                                                            \
+        x = y;                                                                                                            \
+        y = t;                                                                                                            \
+    }                                                                                                                     \
+    *g = x;                                                                                                               \
+}                                                                                                                         \
+                                                                                                                          \
+/* executa op ('+', '*', '/', 'm') em BigInt##BITS; r2 recebe o resto em '/'.                                             \
+   Retorna -1 se os operandos não cabem. */                                                                               \
+static int bigint##BITS##_run(char op, const BigInt *a, const BigInt *b, BigInt **r1, BigInt **r2) {                      \
+    BigInt##BITS x, y, z, w;                                                                                              \
+    if (bigint##BITS##_load(&x, a) != 0 || bigint##BITS##_load(&y, b) != 0) return -1;                                    \
+                                                                                                                          \
+    if (op == '+') {                                                                                                      \
+        bigint##BITS##_add(&z, &x, &y);                                                                                   \
+        *r1 = bigint_from_limbs(z.d, N, z.sign);                                                                          \
+    } else if (op == '*') {                                                                                               \
+        BigInt##BITS##_wide p;                                                                                            \
+        bigint##BITS##_mul(&p, &x, &y);                                                                                   \
+        *r1 = bigint_from_limbs(p.d, 2 * N, p.sign);                                                                      \
+    } else if (op == '/') {                                                                                               \
+        if (bigint##BITS##_divmod(&z, &w, &x, &y) != 0) {                                                                 \
+            *r1 = NULL;                                                                                                   \
+            if (r2) *r2 = NULL;                                                                                           \
+            return 0;                                                                                                     \
+        }                                                                                                                 \
+        *r1 = bigint_from_limbs(z.d, N, z.sign);                                                                          \
+        if (r2) *r2 = bigint_from_limbs(w.d, N, w.sign);                                                                  \
+    } else if (op == 'm') {                                                                                               \
+        bigint##BITS##_gcd(&z, &x, &y);                                                                                   \
+        *r1 = bigint_from_limbs(z.d, N, 1);                                                                               \
+    } else {                                                                                                              \
+        return -1;                                                                                                        \
+    }                                                                                                                     \
+    return 0;                                                                                                             \
+}
+
+BIGINT_FIXED_WIDTHS(DEFINE_BIGINT_FIXED)
+
+/* tenta calcular op com o menor tipo fixo que comporta a e b.
+   Retorna 0 se calculou (resultados em *r1 / *r2), -1 se não cabe. */
+static int bigint_fixed_try(char op, const BigInt *a, const BigInt *b, BigInt **r1, BigInt **r2) {
+    size_t need = (a->len > b->len) ? a->len : b->len;
+    if (op == '+') need++;  /* folga para o carry */
+#define BIGINT_FIXED_ROUTE(BITS, N) \
+    if (need <= N) return bigint##BITS##_run(op, a, b, r1, r2);
+    BIGINT_FIXED_WIDTHS(BIGINT_FIXED_ROUTE)
+#undef BIGINT_FIXED_ROUTE
+    return -1;
+}
+
+/* ------------------ cache.c (memoização LRU) ------------------ */
+
+/* Tabela hash encadeada + lista duplamente ligada em ordem de uso.
+   A chave é (op, a, b); o hash (FNV-1a sobre sinal, tamanho e blocos) só
+   escolhe o bucket, a igualdade é sempre conferida bloco a bloco.
+   Quando o total de bytes passa do orçamento, sai o menos usado. */
+
+#define CACHE_DEFAULT_BUDGET (64u * 1024u * 1024u)
+#define CACHE_BUCKETS 4096   /* potência de dois */
+
+typedef struct CacheEntry {
+    unsigned long long hash;
+    char op;
+    BigInt *a, *b;                    /* cópias das entradas */
+    BigInt *r1, *r2;                  /* resultado (divmod: quociente, resto) */
+    size_t bytes;
+    struct CacheEntry *prev, *next;   /* lista LRU (head = mais recente) */
+    struct CacheEntry *hnext;         /* próximo no mesmo bucket */
+} CacheEntry;
+
+static struct {
+    int enabled;
+    size_t budget;
+    size_t used;
+    CacheEntry *buckets[CACHE_BUCKETS];
+    CacheEntry *head, *tail;
+    unsigned long long hits, misses;
+} bigint_cache = { 1, CACHE_DEFAULT_BUDGET, 0, { NULL }, NULL, NULL, 0, 0 };
+
+static BigInt *bigint_copy(const BigInt *x) {
+    BigInt *r = bigint_new(x->len, x->sign);
+    if (!r) return NULL;
+    memcpy(r->data, x->data, x->len * sizeof(unsigned int));
+    return r;
+}
+
+static unsigned long long cache_hash_bigint(unsigned long long h, const BigInt *x) {
+    h = (h ^ (unsigned long long)(x->sign < 0)) * 1099511628211ull;
+    h = (h ^ (unsigned long long)x->len) * 1099511628211ull;
+    for (size_t i = 0; i < x->len; ++i)
+        h = (h ^ x->data[i]) * 1099511628211ull;
+    return h;
+}
+
+static int bigint_equal(const BigInt *x, const BigInt *y) {
+    return x->sign == y->sign && x->len == y->len &&
+           memcmp(x->data, y->data, x->len * sizeof(unsigned int)) == 0;
+}
+
+static size_t bigint_bytes(const BigInt *x) {
+    return x ? sizeof(BigInt) + x->len * sizeof(unsigned int) : 0;
+}
+
+static void cache_unlink(CacheEntry *e) {
+    if (e->prev) e->prev->next = e->next; else bigint_cache.head = e->next;
+    if (e->next) e->next->prev = e->prev; else bigint_cache.tail = e->prev;
+    e->prev = e->next = NULL;
+}
+
+static void cache_push_front(CacheEntry *e) {
+    e->prev = NULL;
+    e->next = bigint_cache.head;
+    if (bigint_cache.head) bigint_cache.head->prev = e;
+    bigint_cache.head = e;
+    if (!bigint_cache.tail) bigint_cache.tail = e;
+}
+
+static void cache_drop(CacheEntry *e) {
+    CacheEntry **pp = &bigint_cache.buckets[e->hash & (CACHE_BUCKETS - 1)];
+    while (*pp != e) pp = &(*pp)->hnext;
+    *pp = e->hnext;
+    cache_unlink(e);
+    bigint_cache.used -= e->bytes;
+    bigint_free(e->a); bigint_free(e->b);
+    bigint_free(e->r1); bigint_free(e->r2);
+    free(e);
+}
+
+/* procura (op, a, b); em caso de acerto move a entrada para o topo */
+static CacheEntry *cache_lookup(char op, const BigInt *a, const BigInt *b, unsigned long long *hash_out) {
+    unsigned long long h = 14695981039346656037ull;
+    h = (h ^ (unsigned char)op) * 1099511628211ull;
+    h = cache_hash_bigint(h, a);
+    h = cache_hash_bigint(h, b);
+    *hash_out = h;
+
+    for (CacheEntry *e = bigint_cache.buckets[h & (CACHE_BUCKETS - 1)]; e; e = e->hnext) {
+        if (e->hash == h && e->op == op && bigint_equal(e->a, a) && bigint_equal(e->b, b)) {
+            cache_unlink(e);
+            cache_push_front(e);
+            bigint_cache.hits++;
+            return e;
+        }
+    }
+    bigint_cache.misses++;
+    return NULL;
+}
+
+/* guarda cópias de a, b e dos resultados; não faz nada se não couber */
+static void cache_insert(char op, unsigned long long h, const BigInt *a, const BigInt *b,
+                         const BigInt *r1, const BigInt *r2) {
+    size_t bytes = sizeof(CacheEntry) + bigint_bytes(a) + bigint_bytes(b) +
+                   bigint_bytes(r1) + bigint_bytes(r2);
+    if (bytes > bigint_cache.budget) return;
+
+    while (bigint_cache.tail && bigint_cache.used + bytes > bigint_cache.budget)
+        cache_drop(bigint_cache.tail);
+
+    CacheEntry *e = calloc(1, sizeof(CacheEntry));
+    if (!e) return;
+    e->a = bigint_copy(a);
+    e->b = bigint_copy(b);
+    e->r1 = r1 ? bigint_copy(r1) : NULL;
+    e->r2 = r2 ? bigint_copy(r2) : NULL;
+    if (!e->a || !e->b || (r1 && !e->r1) || (r2 && !e->r2)) {
+        bigint_free(e->a); bigint_free(e->b);
+        bigint_free(e->r1); bigint_free(e->r2);
+        free(e);
+        return;
+    }
+    e->hash = h;
+    e->op = op;
+    e->bytes = bytes;
+    e->hnext = bigint_cache.buckets[h & (CACHE_BUCKETS - 1)];
+    bigint_cache.buckets[h & (CACHE_BUCKETS - 1)] = e;
+    cache_push_front(e);
+    bigint_cache.used += bytes;
+}
+
+void bigint_cache_clear(void) {
+    while (bigint_cache.tail) cache_drop(bigint_cache.tail);
+}
+
+/* budget_bytes == 0 mantém o orçamento atual */
+void bigint_cache_config(int enabled, size_t budget_bytes) {
+    bigint_cache.enabled = enabled;
+    if (budget_bytes) bigint_cache.budget = budget_bytes;
+    if (!enabled) bigint_cache_clear();
+    while (bigint_cache.tail && bigint_cache.used > bigint_cache.budget)
+        cache_drop(bigint_cache.tail);
+}
+
+void bigint_cache_stats(unsigned long long *hits, unsigned long long *misses, size_t *bytes) {
+    if (hits) *hits = bigint_cache.hits;
+    if (misses) *misses = bigint_cache.misses;
+    if (bytes) *bytes = bigint_cache.used;
+}
+
+/* cálculo de fato: tipo de largura fixa se os operandos couberem,
+   senão a função genérica */
+static BigInt *compute_binop(char op, const BigInt *a, const BigInt *b,
+                             BigInt *(*fn)(const BigInt *, const BigInt *)) {
+    BigInt *res = NULL;
+    if (bigint_fixed_try(op, a, b, &res, NULL) == 0) return res;
+    return fn(a, b);
+}
+
+static void compute_divmod(const BigInt *a, const BigInt *b, BigInt **q, BigInt **r) {
+    if (bigint_fixed_try('/', a, b, q, r) == 0) return;
+    bigint_divmod(a, b, q, r);
+}
+
+/* operações binárias de resultado único */
+static BigInt *cached_binop(char op, const BigInt *a, const BigInt *b,
+                            BigInt *(*fn)(const BigInt *, const BigInt *)) {
+    if (!a || !b) return NULL;
+    if (!bigint_cache.enabled) return compute_binop(op, a, b, fn);
+
+    unsigned long long h;
+    CacheEntry *e = cache_lookup(op, a, b, &h);
+    if (e) return bigint_copy(e->r1);
+
+    BigInt *res = compute_binop(op, a, b, fn);
+    if (res) cache_insert(op, h, a, b, res, NULL);
+    return res;
+}
+
+BigInt *bigint_add_cached(const BigInt *a, const BigInt *b) { return cached_binop('+', a, b, bigint_add); }
+BigInt *bigint_mul_cached(const BigInt *a, const BigInt *b) { return cached_binop('*', a, b, bigint_mul); }
+BigInt *bigint_gcd_cached(const BigInt *a, const BigInt *b) { return cached_binop('m', a, b, bigint_gcd); }
+
+/* a - b = a + (-b): compartilha as entradas da soma */
+BigInt *bigint_sub_cached(const BigInt *a, const BigInt *b) {
+    if (!a || !b) return NULL;
+    BigInt tmp = *b;
+    tmp.sign = bigint_is_zero(b) ? 1 : -b->sign;
+    return bigint_add_cached(a, &tmp);
+}
+
+void bigint_divmod_cached(const BigInt *a, const BigInt *b, BigInt **q, BigInt **r) {
+    if (q) *q = NULL;
+    if (r) *r = NULL;
+    if (!a || !b) return;
+    if (!bigint_cache.enabled) {
+        BigInt *qq = NULL, *rr = NULL;
+        compute_divmod(a, b, &qq, &rr);
+        if (q) *q = qq; else bigint_free(qq);
+        if (r) *r = rr; else bigint_free(rr);
+        return;
+    }
+
+    unsigned long long h;
+    CacheEntry *e = cache_lookup('/', a, b, &h);
+    if (e) {
+        if (q) *q = bigint_copy(e->r1);
+        if (r) *r = bigint_copy(e->r2);
+        return;
+    }
+
+    /* calcula sempre os dois: '/' e '%' sobre os mesmos operandos se reaproveitam */
+    BigInt *qq = NULL, *rr = NULL;
+    compute_divmod(a, b, &qq, &rr);
+    if (qq && rr) cache_insert('/', h, a, b, qq, rr);
+    if (q) *q = qq; else bigint_free(qq);
+    if (r) *r = rr; else bigint_free(rr);
+}
+
+/* ------------------ reduce.c (soma e produto de listas) ------------------ */
+
+/* Soma: cada bloco acumula em 64 bits sem propagar carry. Um termo soma
+   < BASE por bloco, então cabem ~1.8e10 termos antes de precisar
+   normalizar. Positivos e negativos têm acumuladores separados e só se
+   encontram no final, numa única subtração.
+   Produto: árvore balanceada montada em fluxo, como um contador binário:
+   uma pilha de produtos parciais onde dois do mesmo nível viram um do
+   nível seguinte. Cada multiplicação junta fatores de tamanho parecido e a
+   pilha nunca passa de 64 entradas. */
+
+#define SUMACC_FLUSH_TERMS (1ull << 33)
+#define PRODACC_DEPTH 64
+
+typedef struct {
+    unsigned long long *d;
+    size_t len, cap;
+} LimbAcc;
+
+typedef struct {
+    LimbAcc pos, neg;
+    unsigned long long terms;  /* termos desde a última normalização */
+} SumAcc;
+
+typedef struct {
+    BigInt *items[PRODACC_DEPTH];
+    unsigned int level[PRODACC_DEPTH];
+    size_t n;
+} ProdAcc;
+
+static int limbacc_reserve(LimbAcc *a, size_t n) {
+    if (n <= a->cap) return 0;
+    size_t cap = (a->cap * 2 > n) ? a->cap * 2 : n;
+    unsigned long long *d = realloc(a->d, cap * sizeof(unsigned long long));
+    if (!d) return -1;
+    memset(d + a->cap, 0, (cap - a->cap) * sizeof(unsigned long long));
+    a->d = d;
+    a->cap = cap;
+    return 0;
+}
+
+/* propaga os carries pendentes: depois disso todo bloco é < BASE */
+static int limbacc_carry(LimbAcc *a) {
+    unsigned long long carry = 0;
+    for (size_t i = 0; i < a->len; ++i) {
+        unsigned long long cur = a->d[i] + carry;
+        a->d[i] = cur % BASE;
+        carry = cur / BASE;
+    }
+    while (carry) {
+        if (limbacc_reserve(a, a->len + 1) != 0) return -1;
+        a->d[a->len++] = carry % BASE;
+        carry /= BASE;
+    }
+    return 0;
+}
+
+static BigInt *limbacc_to_bigint(LimbAcc *a, int sign) {
+    if (limbacc_carry(a) != 0) return NULL;
+    BigInt *r = bigint_new(a->len ? a->len : 1, sign);
+    if (!r) return NULL;
+    for (size_t i = 0; i < a->len; ++i) r->data[i] = (unsigned int)a->d[i];
+    bigint_normalize(r);
+    return r;
+}
+
+/* acumulador do sinal dado, já com espaço para n blocos */
+static LimbAcc *sumacc_target(SumAcc *s, int sign, size_t n) {
+    if (s->terms >= SUMACC_FLUSH_TERMS) {
+        if (limbacc_carry(&s->pos) != 0 || limbacc_carry(&s->neg) != 0) return NULL;
+        s->terms = 0;
+    }
+    LimbAcc *t = (sign < 0) ? &s->neg : &s->pos;
+    if (limbacc_reserve(t, n) != 0) return NULL;
+    if (n > t->len) t->len = n;
+    s->terms++;
+    return t;
+}
+
+static int sumacc_add_limbs(SumAcc *s, const unsigned int *d, size_t n, int sign) {
+    LimbAcc *t = sumacc_target(s, sign, n);
+    if (!t) return -1;
+    for (size_t i = 0; i < n; ++i) t->d[i] += d[i];
+    return 0;
+}
+
+/* soma um número em texto. Decimal vai direto dos dígitos para o
+   acumulador, sem BigInt intermediário; prefixos 0x/0o/0b passam pelo
+   parser normal. Retorna -1 para número inválido. */
+static int sumacc_add_text(SumAcc *s, const char *text) {
+    const char *p = text;
+    while (*p && isspace((unsigned char)*p)) p++;
+
+    int sign = 1;
+    if (*p == '+' || *p == '-') {
+        if (*p == '-') sign = -1;
+        p++;
+    }
+
+    if (p[0] == '0' && p[1] != '\0' && strchr("xXoObB", p[1])) {
+        BigInt *x = bigint_from_string(text);
+        if (!x) return -1;
+        int rc = sumacc_add_limbs(s, x->data, x->len, x->sign);
+        bigint_free(x);
+        return rc;
+    }
+
+    while (*p == '0') p++;
+    size_t ndig = 0;
+    while (isdigit((unsigned char)p[ndig])) ndig++;
+    for (const char *t = p + ndig; *t; ++t)
+        if (!isspace((unsigned char)*t)) return -1;
+    if (ndig == 0) return 0;
+
+    size_t nblocks = (ndig + BASE_DIGITS - 1) / BASE_DIGITS;
+    LimbAcc *t = sumacc_target(s, sign, nblocks);
+    if (!t) return -1;
+
+    size_t idx = 0;
+    for (size_t end = ndig; end > 0; ) {
+        size_t start = (end > BASE_DIGITS) ? end - BASE_DIGITS : 0;
+        unsigned int v = 0;
+        for (size_t i = start; i < end; ++i) v = v * 10 + (unsigned int)(p[i] - '0');
+        t->d[idx++] += v;
+        end = start;
+    }
+    return 0;
+}
+
+static BigInt *sumacc_finish(SumAcc *s) {
+    BigInt *P = limbacc_to_bigint(&s->pos, 1);
+    BigInt *N = limbacc_to_bigint(&s->neg, -1);
+    BigInt *res = (P && N) ? bigint_add(P, N) : NULL;
+    bigint_free(P);
+    bigint_free(N);
+    free(s->pos.d);
+    free(s->neg.d);
+    memset(s, 0, sizeof(*s));
+    return res;
+}
+
+/* empilha x (o acumulador passa a ser dono) e junta níveis iguais */
+static int prodacc_push(ProdAcc *p, BigInt *x, unsigned int level) {
+    if (!x) return -1;
+    p->items[p->n] = x;
+    p->level[p->n] = level;
+    p->n++;
+    while (p->n >= 2 && p->level[p->n - 1] == p->level[p->n - 2]) {
+        BigInt *m = compute_binop('*', p->items[p->n - 2], p->items[p->n - 1], bigint_mul);
+        if (!m) return -1;
+        bigint_free(p->items[p->n - 2]);
+        bigint_free(p->items[p->n - 1]);
+        p->n--;
+        p->items[p->n - 1] = m;
+        p->level[p->n - 1]++;
+    }
+    return 0;
+}
+
+static void prodacc_free(ProdAcc *p) {
+    while (p->n > 0) bigint_free(p->items[--p->n]);
+}
+
+/* junta o que sobrou na pilha, dos menores (topo) para os maiores */
+static BigInt *prodacc_finish(ProdAcc *p) {
+    if (p->n == 0) return bigint_from_uint(1);
+    while (p->n > 1) {
+        BigInt *m = compute_binop('*', p->items[p->n - 2], p->items[p->n - 1], bigint_mul);
+        if (!m) { prodacc_free(p); return NULL; }
+        bigint_free(p->items[p->n - 2]);
+        bigint_free(p->items[p->n - 1]);
+        p->n--;
+        p->items[p->n - 1] = m;
+    }
+    p->n = 0;
+    return p->items[0];
+}
+
+BigInt *bigint_sum(BigInt *const *xs, size_t n) {
+    SumAcc s;
+    memset(&s, 0, sizeof(s));
+    for (size_t i = 0; i < n; ++i) {
+        if (sumacc_add_limbs(&s, xs[i]->data, xs[i]->len, xs[i]->sign) != 0) {
+            free(s.pos.d);
+            free(s.neg.d);
+            return NULL;
+        }
+    }
+    return sumacc_finish(&s);
+}
+
+BigInt *bigint_product(BigInt *const *xs, size_t n) {
+    ProdAcc p;
+    p.n = 0;
+    /* as folhas já entram multiplicadas aos pares, sem copiar os operandos */
+    for (size_t i = 0; i < n; i += 2) {
+        int rc = (i + 1 < n)
+            ? prodacc_push(&p, compute_binop('*', xs[i], xs[i + 1], bigint_mul), 1)
+            : prodacc_push(&p, bigint_copy(xs[i]), 0);
+        if (rc != 0) { prodacc_free(&p); return NULL; }
+    }
+    return prodacc_finish(&p);
+}
+
+/* ------------------ matrix.c (multiplicação de matrizes) ------------------ */
+
+/* Cada célula de C = A * B é um produto escalar de k termos.
+   Entradas grandes: cada entrada de A e B é transformada (NTT em três primos)
+   uma única vez, e essa transformada é reaproveitada em todas as células
+   em que a entrada aparece. O produto escalar é acumulado no domínio da
+   transformada (ponto a ponto, mod p) e cada célula faz só uma transformada
+   inversa por sinal, seguida de CRT e de um único passe de carry.
+   Entradas pequenas: escolar, com os produtos de blocos somados em 64 bits
+   sem normalizar (mesmo LimbAcc do somatório).
+   Em ambos os casos as células são independentes e rodam em paralelo
+   (OpenMP). Positivos e negativos vão para acumuladores separados. */
+
+#define MATMUL_NTT_MIN_LIMBS 192
+#define MATMUL_NTT_MAX_TERMS 50000000ull  /* k * blocos: coeficiente < p1*p2*p3 */
+#define MATMUL_NTT_MAX_LEN (1u << 23)      /* 998244353 = 119 * 2^23 + 1 */
+#define MATMUL_NTT_MAX_BYTES (1ull << 30)  /* transformadas de todas as entradas */
+
+static const unsigned int ntt_primes[3] = { 998244353u, 167772161u, 469762049u };  /* raiz 3 */
+
+static unsigned int ntt_pow(unsigned long long b, unsigned long long e, unsigned int p) {
+    unsigned long long r = 1;
+    b %= p;
+    while (e) {
+        if (e & 1) r = r * b % p;
+        b = b * b % p;
+        e >>= 1;
+    }
+    return (unsigned int)r;
+}
+
+/* NTT iterativa in-place; n potência de dois */
+static void ntt(unsigned int *a, size_t n, unsigned int p, int invert) {
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) { unsigned int t = a[i]; a[i] = a[j]; a[j] = t; }
+    }
+    for (size_t len = 2; len <= n; len <<= 1) {
+        unsigned long long w = ntt_pow(3, (p - 1) / len, p);
+        if (invert) w = ntt_pow(w, p - 2, p);
+        size_t half = len / 2;
+        for (size_t i = 0; i < n; i += len) {
+            unsigned long long wn = 1;
+            for (size_t k = 0; k < half; ++k) {
+                unsigned int u = a[i + k];
+                unsigned int v = (unsigned int)(a[i + k + half] * wn % p);
+                a[i + k] = (u + v >= p) ? u + v - p : u + v;
+                a[i + k + half] = (u >= v) ? u - v : u + p - v;
+                wn = wn * w % p;
+            }
+        }
+    }
+    if (invert) {
+        unsigned long long ninv = ntt_pow(n, p - 2, p);
+        for (size_t i = 0; i < n; ++i) a[i] = (unsigned int)(a[i] * ninv % p);
+    }
+}
+
+/* transformada de uma entrada: sign == 0 marca entrada zero (f == NULL) */
+typedef struct {
+    int sign;
+    unsigned int *f;   /* 3 * L valores, um bloco de L por primo */
+} NttEntry;
+
+static int ntt_entry_init(NttEntry *e, const BigInt *x, size_t L) {
+    e->f = NULL;
+    e->sign = bigint_is_zero(x) ? 0 : x->sign;
+    if (!e->sign) return 0;
+    e->f = calloc(3 * L, sizeof(unsigned int));
+    if (!e->f) return -1;
+    for (int q = 0; q < 3; ++q) {
+        unsigned int *f = e->f + (size_t)q * L;
+        for (size_t t = 0; t < x->len; ++t) f[t] = x->data[t] % ntt_primes[q];
+        ntt(f, L, ntt_primes[q], 0);
+    }
+    return 0;
+}
+
+/* 3 resíduos por coeficiente -> soma os blocos base 1e9 em out (sem carry) */
+static void ntt_crt_to_limbs(const unsigned int *acc, size_t L, unsigned long long *out) {
+    const unsigned long long p1 = ntt_primes[0], p2 = ntt_primes[1], p3 = ntt_primes[2];
+    const unsigned long long inv12 = ntt_pow(p1, p2 - 2, (unsigned int)p2);
+    const unsigned long long inv13 = ntt_pow(p1, p3 - 2, (unsigned int)p3);
+    const unsigned long long inv23 = ntt_pow(p2, p3 - 2, (unsigned int)p3);
+
+    for (size_t t = 0; t < L; ++t) {
+        /* Garner: valor = x1 + x2*p1 + x3*p1*p2 */
+        unsigned long long x1 = acc[t];
+        unsigned long long x2 = (acc[L + t] + p2 - x1 % p2) % p2 * inv12 % p2;
+        unsigned long long x3 = (acc[2 * L + t] + p3 - x1 % p3) % p3 * inv13 % p3;
+        x3 = (x3 + p3 - x2 % p3) % p3 * inv23 % p3;
+
+        unsigned long long v[3] = { x3, 0, 0 };
+        unsigned long long mulby[2] = { p2, p1 }, add[2] = { x2, x1 };
+        for (int s = 0; s < 2; ++s) {
+            unsigned long long carry = add[s];
+            for (int i = 0; i < 3; ++i) {
+                unsigned long long cur = v[i] * mulby[s] + carry;
+                v[i] = cur % BASE;
+                carry = cur / BASE;
+            }
+        }
+        out[t] += v[0];
+        out[t + 1] += v[1];
+        out[t + 2] += v[2];
+    }
+}
+
+/* célula (i, j) pelo caminho NTT */
+static BigInt *matmul_cell_ntt(const NttEntry *FA, const NttEntry *FB, size_t i, size_t j,
+                               size_t K, size_t C, size_t L) {
+    unsigned int *acc[2] = { calloc(3 * L, sizeof(unsigned int)), calloc(3 * L, sizeof(unsigned int)) };
+    int used[2] = { 0, 0 };
+    BigInt *part[2] = { NULL, NULL };
+    BigInt *res = NULL;
+    if (!acc[0] || !acc[1]) goto out;
+
+    for (size_t kk = 0; kk < K; ++kk) {
+        const NttEntry *ea = &FA[i * K + kk], *eb = &FB[kk * C + j];
+        if (!ea->sign || !eb->sign) continue;
+        int s = (ea->sign * eb->sign < 0);
+        used[s] = 1;
+        for (int q = 0; q < 3; ++q) {
+            unsigned long long p = ntt_primes[q];
+            const unsigned int *fa = ea->f + (size_t)q * L, *fb = eb->f + (size_t)q * L;
+            unsigned int *dst = acc[s] + (size_t)q * L;
+            for (size_t t = 0; t < L; ++t)
+                dst[t] = (unsigned int)((dst[t] + (unsigned long long)fa[t] * fb[t]) % p);
+        }
+    }
+
+    for (int s = 0; s < 2; ++s) {
+        LimbAcc la = { NULL, 0, 0 };
+        if (used[s]) {
+            for (int q = 0; q < 3; ++q) ntt(acc[s] + (size_t)q * L, L, ntt_primes[q], 1);
+            if (limbacc_reserve(&la, L + 3) != 0) goto out;
+            la.len = L + 3;
+            ntt_crt_to_limbs(acc[s], L, la.d);
+        }
+        part[s] = limbacc_to_bigint(&la, s ? -1 : 1);
+        free(la.d);
+        if (!part[s]) goto out;
+    }
+    res = bigint_add(part[0], part[1]);
+
+out:
+    free(acc[0]); free(acc[1]);
+    bigint_free(part[0]); bigint_free(part[1]);
+    return res;
+}
+
+/* célula (i, j) pelo caminho escolar com carry adiado */
+static BigInt *matmul_cell_school(BigInt *const *A, BigInt *const *B, size_t i, size_t j,
+                                  size_t K, size_t C) {
+    LimbAcc acc[2] = { { NULL, 0, 0 }, { NULL, 0, 0 } };
+    unsigned long long adds = 0;  /* somas por posição desde o último carry (limite) */
+    BigInt *part[2] = { NULL, NULL };
+    BigInt *res = NULL;
+
+    for (size_t kk = 0; kk < K; ++kk) {
+        const BigInt *a = A[i * K + kk], *b = B[kk * C + j];
+        if (bigint_is_zero(a) || bigint_is_zero(b)) continue;
+        LimbAcc *t = &acc[a->sign * b->sign < 0];
+        size_t n = a->len + b->len;
+        if (limbacc_reserve(t, n) != 0) goto out;
+        if (n > t->len) t->len = n;
+
+        size_t step = 2 * ((a->len < b->len) ? a->len : b->len);
+        if (adds + step >= SUMACC_FLUSH_TERMS) {
+            if (limbacc_carry(&acc[0]) != 0 || limbacc_carry(&acc[1]) != 0) goto out;
+            adds = 0;
+        }
+        adds += step;
+
+        for (size_t x = 0; x < a->len; ++x) {
+            unsigned long long av = a->data[x];
+            unsigned long long *d = t->d + x;
+            for (size_t y = 0; y < b->len; ++y) {
+                unsigned long long pr = av * b->data[y];
+                d[y] += pr % BASE;
+                d[y + 1] += pr / BASE;
+            }
+        }
+    }
+
+    part[0] = limbacc_to_bigint(&acc[0], 1);
+    part[1] = limbacc_to_bigint(&acc[1], -1);
+    if (part[0] && part[1]) res = bigint_add(part[0], part[1]);
+
+out:
+    free(acc[0].d); free(acc[1].d);
+    bigint_free(part[0]); bigint_free(part[1]);
+    return res;
+}
+
+BigInt **bigint_matmul(BigInt *const *A, BigInt *const *B, size_t r, size_t k, size_t c) {
+    if (!A || !B || r == 0 || c == 0) return NULL;
+
+    BigInt **C = calloc(r * c, sizeof(BigInt *));
+    if (!C) return NULL;
+
+    size_t maxa = 1, maxb = 1;
+    for (size_t i = 0; i < r * k; ++i) if (A[i]->len > maxa) maxa = A[i]->len;
+    for (size_t i = 0; i < k * c; ++i) if (B[i]->len > maxb) maxb = B[i]->len;
+    size_t minlen = (maxa < maxb) ? maxa : maxb;
+
+    /* todas as entradas são transformadas no mesmo L (o do maior par), a
+       12 * L bytes cada: uma entrada enorme encarece todas as outras */
+    size_t L = 1;
+    while (L < maxa + maxb) L <<= 1;
+    int use_ntt = minlen >= MATMUL_NTT_MIN_LIMBS &&
+                  (unsigned long long)k * minlen < MATMUL_NTT_MAX_TERMS &&
+                  maxa + maxb <= MATMUL_NTT_MAX_LEN &&
+                  (unsigned long long)(r * k + k * c) * 3 * sizeof(unsigned int) * L <= MATMUL_NTT_MAX_BYTES;
+    NttEntry *FA = NULL, *FB = NULL;
+    int failed = 0;
+
+    if (use_ntt) {
+        FA = calloc(r * k, sizeof(NttEntry));
+        FB = calloc(k * c, sizeof(NttEntry));
+        if (!FA || !FB) failed = 1;
+
+        /* transformada direta: uma vez por entrada */
+        long ne = failed ? 0 : (long)(r * k + k * c);
+        #pragma omp parallel for schedule(dynamic)
+        for (long e = 0; e < ne; ++e) {
+            int rc = (e < (long)(r * k))
+                ? ntt_entry_init(&FA[e], A[e], L)
+                : ntt_entry_init(&FB[e - (long)(r * k)], B[e - (long)(r * k)], L);
+            if (rc != 0) {
+                #pragma omp atomic write
+                failed = 1;
+            }
+        }
+
+        /* sem memória para as transformadas: o escolar ainda dá conta */
+        if (failed) {
+            if (FA) for (size_t i = 0; i < r * k; ++i) free(FA[i].f);
+            if (FB) for (size_t i = 0; i < k * c; ++i) free(FB[i].f);
+            free(FA);
+            free(FB);
+            FA = FB = NULL;
+            use_ntt = 0;
+            failed = 0;
+        }
+    }
+
+    long ncells = failed ? 0 : (long)(r * c);
+    #pragma omp parallel for schedule(dynamic)
+    for (long cell = 0; cell < ncells; ++cell) {
+        size_t i = (size_t)cell / c, j = (size_t)cell % c;
+        C[cell] = use_ntt ? matmul_cell_ntt(FA, FB, i, j, k, c, L) : NULL;
+        if (!C[cell]) C[cell] = matmul_cell_school(A, B, i, j, k, c);
+    }
+
+    if (FA) for (size_t i = 0; i < r * k; ++i) free(FA[i].f);
+    if (FB) for (size_t i = 0; i < k * c; ++i) free(FB[i].f);
+    free(FA);
+    free(FB);
+
+    for (size_t i = 0; i < r * c && !failed; ++i) if (!C[i]) failed = 1;
+    if (failed) {
+        for (size_t i = 0; i < r * c; ++i) bigint_free(C[i]);
+        free(C);
+        return NULL;
+    }
+    return C;
+}
+
+/* ------------------ prime.c (primalidade e fatoração) ------------------ */
+
+/* Primalidade: divisão por primos pequenos (crivo até TRIAL_LIMIT) e depois
+   BPSW (Miller–Rabin base 2 + Lucas forte com parâmetros de Selfridge),
+   opcionalmente com rodadas extras de Miller–Rabin.
+   Fatoração: divisão por primos pequenos e depois Pollard-rho (variante de
+   Brent), com caminhadas independentes (c diferentes) em paralelo, uma por
+   thread; a primeira que achar um fator encerra as outras.
+   Toda a aritmética modular dos laços internos é de Montgomery em base 1e9
+   (R = BASE^n), o que exige módulo primo com 10: 2 e 5 sempre saem na
+   divisão por primos pequenos. bigint_divmod só aparece na preparação
+   (R mod n, R^2 mod n) e o MDC do rho é feito a cada RHO_BATCH passos. */
+
+#define TRIAL_LIMIT (1u << 20)
+#define RHO_BATCH 256
+#define RHO_DEFAULT_ITERS (1ull << 20)   /* passos por thread */
+#define PRIME_EXTRA_ROUNDS 4
+
+static unsigned int *small_primes = NULL;
+static size_t n_small_primes = 0;
+
+/* crivo de Eratóstenes, feito uma vez (fora de regiões paralelas) */
+static int small_primes_init(void) {
+    if (small_primes) return 0;
+    unsigned char *comp = calloc(TRIAL_LIMIT, 1);
+    if (!comp) return -1;
+    size_t count = 0;
+    for (unsigned int i = 2; i < TRIAL_LIMIT; ++i) {
+        if (comp[i]) continue;
+        count++;
+        for (unsigned long long j = (unsigned long long)i * i; j < TRIAL_LIMIT; j += i) comp[j] = 1;
+    }
+    small_primes = malloc(count * sizeof(unsigned int));
+    if (!small_primes) { free(comp); return -1; }
+    for (unsigned int i = 2; i < TRIAL_LIMIT; ++i)
+        if (!comp[i]) small_primes[n_small_primes++] = i;
+    free(comp);
+    return 0;
+}
+
+/* a mod p para p pequeno (< 2^32 / ... cabe com folga em 64 bits) */
+static unsigned int bigint_mod_small(const BigInt *a, unsigned int p) {
+    unsigned long long rem = 0;
+    for (size_t i = a->len; i-- > 0;) rem = (rem * BASE + a->data[i]) % p;
+    return (unsigned int)rem;
+}
+
+/* a /= p, in-place (divisão exata ou não, descarta o resto) */
+static void bigint_div_small_inplace(BigInt *a, unsigned int p) {
+    unsigned long long rem = 0;
+    for (size_t i = a->len; i-- > 0;) {
+        unsigned long long cur = rem * BASE + a->data[i];
+        a->data[i] = (unsigned int)(cur / p);
+        rem = cur % p;
+    }
+    bigint_normalize(a);
+}
+
+/* valor de a se couber em 64 bits (até 2 blocos), senão ULLONG_MAX */
+static unsigned long long bigint_small_value(const BigInt *a) {
+    if (a->len > 2) return ULLONG_MAX;
+    return (a->len == 2) ? (unsigned long long)a->data[1] * BASE + a->data[0] : a->data[0];
+}
+
+/* ---- Montgomery em base 1e9 ---- */
+
+typedef struct {
+    size_t n;            /* blocos do módulo */
+    unsigned int *m;     /* módulo (primo com 10) */
+    unsigned int minv;   /* -m^-1 mod BASE */
+    unsigned int *one;   /* R mod m: o 1 em forma de Montgomery */
+    unsigned int *r2;    /* R^2 mod m: para converter para a forma de Montgomery */
+} MontCtx;
+
+static void mont_free(MontCtx *c) {
+    free(c->m); free(c->one); free(c->r2);
+    c->m = c->one = c->r2 = NULL;
+}
+
+static int limbs_cmp(const unsigned int *a, const unsigned int *b, size_t n) {
+    for (size_t i = n; i-- > 0;) {
+        if (a[i] != b[i]) return (a[i] < b[i]) ? -1 : 1;
+    }
+    return 0;
+}
+
+static int limbs_is_zero(const unsigned int *a, size_t n) {
+    for (size_t i = 0; i < n; ++i) if (a[i]) return 0;
+    return 1;
+}
+
+/* a -= b em n blocos; retorna o empréstimo final */
+static unsigned int limbs_sub(unsigned int *a, const unsigned int *b, size_t n) {
+    unsigned int borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+        unsigned int bv = b[i] + borrow;
+        borrow = (a[i] < bv);
+        a[i] = borrow ? a[i] + BASE - bv : a[i] - bv;
+    }
+    return borrow;
+}
+
+/* a += b em n blocos; retorna o carry final */
+static unsigned int limbs_add(unsigned int *a, const unsigned int *b, size_t n) {
+    unsigned int carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        unsigned int s = a[i] + b[i] + carry;
+        carry = (s >= BASE);
+        a[i] = carry ? s - BASE : s;
+    }
+    return carry;
+}
+
+/* resto de x por m, com x em blocos (preparação: usa divmod) */
+static int mont_reduce_setup(const BigInt *x, const BigInt *m, unsigned int *out, size_t n) {
+    BigInt *q = NULL, *r = NULL;
+    compute_divmod(x, m, &q, &r);
+    bigint_free(q);
+    if (!r) return -1;
+    memset(out, 0, n * sizeof(unsigned int));
+    memcpy(out, r->data, r->len * sizeof(unsigned int));
+    bigint_free(r);
+    return 0;
+}
+
+static int mont_init(MontCtx *c, const BigInt *m) {
+    size_t n = m->len;
+    c->n = n;
+    c->m = malloc(n * sizeof(unsigned int));
+    c->one = malloc(n * sizeof(unsigned int));
+    c->r2 = malloc(n * sizeof(unsigned int));
+    if (!c->m || !c->one || !c->r2) { mont_free(c); return -1; }
+    memcpy(c->m, m->data, n * sizeof(unsigned int));
+
+    /* inverso de m[0] mod BASE (Euclides estendido) */
+    long long t = 0, newt = 1, r = BASE, newr = m->data[0];
+    while (newr) {
+        long long q = r / newr, tmp;
+        tmp = t - q * newt; t = newt; newt = tmp;
+        tmp = r - q * newr; r = newr; newr = tmp;
+    }
+    if (t < 0) t += BASE;
+    c->minv = (unsigned int)((BASE - (unsigned long long)t) % BASE);
+
+    unsigned int one_data = 1;
+    BigInt one = { 1, 1, &one_data };
+    BigInt *R = bigint_shift_blocks(&one, n);
+    BigInt *R2 = bigint_shift_blocks(&one, 2 * n);
+    int rc = (R && R2) ? 0 : -1;
+    if (rc == 0) rc = mont_reduce_setup(R, m, c->one, n);
+    if (rc == 0) rc = mont_reduce_setup(R2, m, c->r2, n);
+    bigint_free(R);
+    bigint_free(R2);
+    if (rc != 0) mont_free(c);
+    return rc;
+}
+
+/* out = a * b * R^-1 mod m (CIOS). t: rascunho de n + 2 blocos.
+   out pode ser a ou b. */
+static void mont_mul(const MontCtx *c, unsigned int *out, const unsigned int *a,
+                     const unsigned int *b, unsigned int *t) {
+    size_t n = c->n;
+    const unsigned int *m = c->m;
+    memset(t, 0, (n + 2) * sizeof(unsigned int));
+
+    for (size_t i = 0; i < n; ++i) {
+        unsigned long long ai = a[i], carry = 0, cur;
+        for (size_t j = 0; j < n; ++j) {
+            cur = t[j] + ai * b[j] + carry;
+            t[j] = (unsigned int)(cur % BASE);
+            carry = cur / BASE;
+        }
+        cur = t[n] + carry;
+        t[n] = (unsigned int)(cur % BASE);
+        t[n + 1] = (unsigned int)(cur / BASE);
+
+        /* soma mq * m para zerar o bloco mais baixo e desloca um bloco */
+        unsigned long long mq = (unsigned long long)t[0] * c->minv % BASE;
+        carry = (t[0] + mq * m[0]) / BASE;
+        for (size_t j = 1; j < n; ++j) {
+            cur = t[j] + mq * m[j] + carry;
+            t[j - 1] = (unsigned int)(cur % BASE);
+            carry = cur / BASE;
+        }
+        cur = t[n] + carry;
+        t[n - 1] = (unsigned int)(cur % BASE);
+        t[n] = t[n + 1] + (unsigned int)(cur / BASE);
+        t[n + 1] = 0;
+    }
+
+    if (t[n] || limbs_cmp(t, m, n) >= 0) limbs_sub(t, m, n);
+    memcpy(out, t, n * sizeof(unsigned int));
+}
+
+/* out = a + b mod m */
+static void mont_add(const MontCtx *c, unsigned int *out, const unsigned int *a, const unsigned int *b) {
+    if (out != a) memcpy(out, a, c->n * sizeof(unsigned int));
+    unsigned int carry = limbs_add(out, b, c->n);
+    if (carry || limbs_cmp(out, c->m, c->n) >= 0) limbs_sub(out, c->m, c->n);
+}
+
+/* out = a - b mod m */
+static void mont_sub(const MontCtx *c, unsigned int *out, const unsigned int *a, const unsigned int *b) {
+    if (out != a) memcpy(out, a, c->n * sizeof(unsigned int));
+    if (limbs_sub(out, b, c->n)) limbs_add(out, c->m, c->n);
+}
+
+/* x = x / 2 mod m (m ímpar) */
+static void mont_half(const MontCtx *c, unsigned int *x) {
+    unsigned long long rem = 0;
+    if (x[0] & 1) rem = limbs_add(x, c->m, c->n);
+    for (size_t i = c->n; i-- > 0;) {
+        unsigned long long cur = rem * BASE + x[i];
+        x[i] = (unsigned int)(cur >> 1);
+        rem = cur & 1;
+    }
+}
+
+/* inteiro pequeno com sinal (|k| < m) -> forma de Montgomery */
+static void mont_from_small(const MontCtx *c, unsigned int *out, long long k, unsigned int *t) {
+    unsigned int *x = t + c->n + 2;  /* t tem espaço para 2n + 2 blocos */
+    memset(x, 0, c->n * sizeof(unsigned int));
+    unsigned long long a = (unsigned long long)(k < 0 ? -k : k);
+    x[0] = (unsigned int)(a % BASE);
+    if (c->n > 1) x[1] = (unsigned int)(a / BASE);
+    if (k < 0) {
+        unsigned int *y = out;
+        memcpy(y, c->m, c->n * sizeof(unsigned int));
+        limbs_sub(y, x, c->n);
+        memcpy(x, y, c->n * sizeof(unsigned int));
+    }
+    mont_mul(c, out, x, c->r2, t);
+}
+
+/* out = base^e, e em palavras de 32 bits (e > 0) */
+static void mont_pow(const MontCtx *c, unsigned int *out, const unsigned int *base,
+                     const unsigned int *e, size_t ne, unsigned int *t) {
+    size_t top = ne * 32;
+    while (top > 0 && !((e[(top - 1) / 32] >> ((top - 1) % 32)) & 1)) top--;
+    memcpy(out, base, c->n * sizeof(unsigned int));
+    for (size_t bit = top - 1; bit-- > 0;) {
+        mont_mul(c, out, out, out, t);
+        if ((e[bit / 32] >> (bit % 32)) & 1) mont_mul(c, out, out, base, t);
+    }
+}
+
+/* ---- testes ---- */
+
+/* palavras de x deslocadas à direita até ficar ímpar; *s recebe o deslocamento */
+static void words_strip_twos(unsigned int *w, size_t *nw, unsigned int *s) {
+    size_t n = *nw;
+    unsigned int shift = 0;
+    size_t ws = 0;
+    while (ws < n && w[ws] == 0) ws++;
+    unsigned int bs = 0;
+    while (!((w[ws] >> bs) & 1)) bs++;
+    shift = (unsigned int)(ws * 32 + bs);
+    for (size_t i = 0; i + ws < n; ++i) {
+        unsigned int v = w[i + ws] >> bs;
+        if (bs && i + ws + 1 < n) v |= w[i + ws + 1] << (32 - bs);
+        w[i] = v;
+    }
+    n -= ws;
+    while (n > 0 && w[n - 1] == 0) n--;
+    *nw = n;
+    *s = shift;
+}
+
+/* Miller–Rabin forte com base já em forma de Montgomery.
+   d, s: n - 1 = d * 2^s. Retorna 1 se passa (primo provável). */
+static int mr_round(const MontCtx *c, const unsigned int *base, const unsigned int *d, size_t nd,
+                    unsigned int s, unsigned int *x, unsigned int *minus_one, unsigned int *t) {
+    size_t n = c->n;
+    mont_pow(c, x, base, d, nd, t);
+    if (limbs_cmp(x, c->one, n) == 0 || limbs_cmp(x, minus_one, n) == 0) return 1;
+    for (unsigned int r = 1; r < s; ++r) {
+        mont_mul(c, x, x, x, t);
+        if (limbs_cmp(x, minus_one, n) == 0) return 1;
+        if (limbs_cmp(x, c->one, n) == 0) return 0;
+    }
+    return 0;
+}
+
+/* símbolo de Jacobi (a/m), m ímpar positivo pequeno */
+static int jacobi_small(unsigned long long a, unsigned long long m) {
+    int j = 1;
+    a %= m;
+    while (a) {
+        while (!(a & 1)) {
+            a >>= 1;
+            if ((m & 7) == 3 || (m & 7) == 5) j = -j;
+        }
+        unsigned long long tmp = a; a = m; m = tmp;
+        if ((a & 3) == 3 && (m & 3) == 3) j = -j;
+        a %= m;
+    }
+    return (m == 1) ? j : 0;
+}
+
+/* (D/n) para n grande ímpar e D pequeno ímpar com sinal */
+static int jacobi_big(long long D, const BigInt *n) {
+    unsigned int a = (unsigned int)(D < 0 ? -D : D);
+    unsigned int n4 = n->data[0] & 3;  /* BASE é múltiplo de 4 */
+    int j = jacobi_small(bigint_mod_small(n, a), a);
+    if ((a & 3) == 3 && n4 == 3) j = -j;
+    if (D < 0 && n4 == 3) j = -j;
+    return j;
+}
+
+/* n é quadrado perfeito? 1 sim, 0 não, -1 erro (Newton com divmod; só na
+   preparação do Lucas) */
+static int bigint_is_square(const BigInt *n) {
+    unsigned int one_data = 1;
+    BigInt one = { 1, 1, &one_data };
+    BigInt *x = bigint_shift_blocks(&one, (n->len + 1) / 2);  /* >= sqrt(n) */
+    if (!x) return -1;
+    for (;;) {
+        BigInt *q = NULL;
+        compute_divmod(n, x, &q, NULL);
+        BigInt *s = q ? bigint_add(x, q) : NULL;
+        BigInt *y = s ? bigint_shr(s, 1) : NULL;
+        bigint_free(q);
+        bigint_free(s);
+        if (!y) { bigint_free(x); return -1; }
+        if (bigint_cmpabs(y, x) >= 0) { bigint_free(y); break; }
+        bigint_free(x);
+        x = y;
+    }
+    BigInt *sq = compute_binop('*', x, x, bigint_mul);
+    int res = !sq ? -1 : bigint_cmpabs(sq, n) == 0;
+    bigint_free(sq);
+    bigint_free(x);
+    return res;
+}
+
+/* Lucas forte (Selfridge: P = 1, Q = (1 - D) / 4). n ímpar, primo com 10,
+   maior que TRIAL_LIMIT. Retorna 1 se passa. */
+static int strong_lucas(const MontCtx *c, const BigInt *n, unsigned int *t) {
+    long long D = 5;
+    for (;;) {
+        int j = jacobi_big(D, n);
+        if (j == -1) break;
+        if (j == 0) return 0;  /* D divide n (n > |D|) */
+        D = (D > 0) ? -(D + 2) : -(D - 2);
+        /* quadrado perfeito nunca acha (D/n) = -1: testa uma vez, depois de
+           alguns D (5, -7, 9, -11) sem sucesso; erro também encerra */
+        if (D == 13 && bigint_is_square(n) != 0) return 0;
+    }
+    long long Q = (1 - D) / 4;
+
+    size_t nl = c->n, nw = 0;
+    unsigned int *wn = bigint_to_words(n, &nw);
+    unsigned int *w = wn ? calloc(nw + 1, sizeof(unsigned int)) : NULL;
+    if (!w) { free(wn); return 0; }
+    memcpy(w, wn, nw * sizeof(unsigned int));
+    free(wn);
+    /* n + 1 */
+    for (size_t i = 0; ++w[i] == 0; ++i) {}
+    if (w[nw]) nw++;
+    unsigned int s;
+    words_strip_twos(w, &nw, &s);
+
+    unsigned int *buf = malloc(6 * nl * sizeof(unsigned int));
+    if (!buf) { free(w); return 0; }
+    unsigned int *U = buf, *V = U + nl, *Qk = V + nl, *Dm = Qk + nl, *Qm = Dm + nl, *tmp = Qm + nl;
+
+    mont_from_small(c, Dm, D, t);
+    mont_from_small(c, Qm, Q, t);
+    memcpy(U, c->one, nl * sizeof(unsigned int));
+    memcpy(V, c->one, nl * sizeof(unsigned int));  /* V_1 = P = 1 */
+    memcpy(Qk, Qm, nl * sizeof(unsigned int));
+
+    size_t top = nw * 32;
+    while (top > 0 && !((w[(top - 1) / 32] >> ((top - 1) % 32)) & 1)) top--;
+    for (size_t bit = top - 1; bit-- > 0;) {
+        /* dobra o índice: U_2k = U_k V_k, V_2k = V_k^2 - 2 Q^k */
+        mont_mul(c, U, U, V, t);
+        mont_mul(c, V, V, V, t);
+        mont_sub(c, V, V, Qk);
+        mont_sub(c, V, V, Qk);
+        mont_mul(c, Qk, Qk, Qk, t);
+        if ((w[bit / 32] >> (bit % 32)) & 1) {
+            /* soma 1: U' = (U + V) / 2, V' = (D U + V) / 2 */
+            mont_mul(c, tmp, Dm, U, t);
+            mont_add(c, tmp, tmp, V);
+            mont_half(c, tmp);
+            mont_add(c, U, U, V);
+            mont_half(c, U);
+            memcpy(V, tmp, nl * sizeof(unsigned int));
+            mont_mul(c, Qk, Qk, Qm, t);
+        }
+    }
+
+    int res = limbs_is_zero(U, nl) || limbs_is_zero(V, nl);
+    for (unsigned int r = 1; r < s && !res; ++r) {
+        mont_mul(c, V, V, V, t);
+        mont_sub(c, V, V, Qk);
+        mont_sub(c, V, V, Qk);
+        mont_mul(c, Qk, Qk, Qk, t);
+        res = limbs_is_zero(V, nl);
+    }
+    free(buf);
+    free(w);
+    return res;
+}
+
+/* BPSW + rounds rodadas extras de MR (bases 3, 5, 7, ...).
+   n ímpar, primo com 10, maior que TRIAL_LIMIT. */
+static int bpsw(const BigInt *n, int rounds) {
+    MontCtx c;
+    if (mont_init(&c, n) != 0) return 0;
+    size_t nl = c.n;
+
+    size_t nd = 0;
+    unsigned int *d = bigint_to_words(n, &nd);
+    unsigned int *buf = malloc((5 * nl + 2) * sizeof(unsigned int));
+    if (!d || !buf) { free(d); free(buf); mont_free(&c); return 0; }
+    unsigned int *t = buf, *x = t + 2 * nl + 2, *base = x + nl, *minus_one = base + nl;
+
+    d[0] -= 1;  /* n ímpar: n - 1 só mexe na palavra mais baixa */
+    unsigned int s;
+    words_strip_twos(d, &nd, &s);
+    memset(minus_one, 0, nl * sizeof(unsigned int));
+    mont_sub(&c, minus_one, minus_one, c.one);  /* -1 */
+
+    mont_from_small(&c, base, 2, t);
+    int res = mr_round(&c, base, d, nd, s, x, minus_one, t);
+    if (res) res = strong_lucas(&c, n, t);
+    for (int r = 0; r < rounds && res; ++r) {
+        mont_from_small(&c, base, small_primes[r + 1], t);
+        res = mr_round(&c, base, d, nd, s, x, minus_one, t);
+    }
+
+    free(buf);
+    free(d);
+    mont_free(&c);
+    return res;
+}
+
+int bigint_is_prime(const BigInt *n, int rounds) {
+    if (!n || n->sign < 0 || bigint_small_value(n) < 2) return 0;
+    if (small_primes_init() != 0) return 0;
+
+    unsigned long long v = bigint_small_value(n);
+    for (size_t i = 0; i < n_small_primes; ++i) {
+        unsigned long long p = small_primes[i];
+        if (p * p > v) return 1;
+        if (bigint_mod_small(n, (unsigned int)p) == 0) return v == p;
+    }
+    if (v < (unsigned long long)TRIAL_LIMIT * TRIAL_LIMIT) return 1;
+    return bpsw(n, rounds);
+}
+
+/* ---- Pollard-rho (Brent) ---- */
+
+/* compara palavras base 2^32 (sem zeros no topo) */
+static int words_cmp(const unsigned int *a, size_t na, const unsigned int *b, size_t nb) {
+    if (na != nb) return (na < nb) ? -1 : 1;
+    for (size_t i = na; i-- > 0;) {
+        if (a[i] != b[i]) return (a[i] < b[i]) ? -1 : 1;
+    }
+    return 0;
+}
+
+/* a -= b (a >= b); atualiza *na */
+static void words_sub(unsigned int *a, size_t *na, const unsigned int *b, size_t nb) {
+    unsigned long long borrow = 0;
+    for (size_t i = 0; i < *na && (i < nb || borrow); ++i) {
+        unsigned long long bi = ((i < nb) ? b[i] : 0) + borrow;
+        borrow = a[i] < bi;
+        a[i] = (unsigned int)(a[i] - bi);
+    }
+    while (*na > 0 && a[*na - 1] == 0) (*na)--;
+}
+
+/* MDC de um resíduo com o módulo (ímpar), por MDC binário (Stein) nas
+   palavras de 32 bits: só subtrações e shifts, sem bigint_divmod, em
+   qualquer tamanho. Thread-safe (sem cache). */
+static BigInt *mont_gcd(const MontCtx *c, const unsigned int *x, const BigInt *n) {
+    BigInt xb = { 1, c->n, (unsigned int *)x };
+    size_t nu = 0, nv = 0;
+    unsigned int *u = bigint_to_words(&xb, &nu);
+    unsigned int *v = bigint_to_words(n, &nv);
+    if (!u || !v) { free(u); free(v); return NULL; }
+    if (nu == 0) { free(u); free(v); return bigint_abs_copy(n); }
+
+    /* n é ímpar: os fatores 2 de x não mudam o MDC */
+    unsigned int s;
+    words_strip_twos(u, &nu, &s);
+    for (;;) {
+        /* u e v ímpares */
+        if (words_cmp(u, nu, v, nv) > 0) {
+            unsigned int *tw = u; u = v; v = tw;
+            size_t tn = nu; nu = nv; nv = tn;
+        }
+        words_sub(v, &nv, u, nu);
+        if (nv == 0) break;
+        words_strip_twos(v, &nv, &s);
+    }
+
+    BigInt *g = bigint_from_words(u, nu, 1);
+    free(u);
+    free(v);
+    return g;
+}
+
+/* outra thread já achou um fator? */
+static int rho_stopped(int *stop) {
+    int st;
+    #pragma omp atomic read
+    st = *stop;
+    return st;
+}
+
+/* quantos passos o próximo lote pode dar: até RHO_BATCH, sem passar do
+   fim da rodada (left) nem do orçamento */
+static unsigned long long rho_batch(unsigned long long left, unsigned long long max_iters,
+                                    unsigned long long iters) {
+    unsigned long long lim = (left < RHO_BATCH) ? left : RHO_BATCH;
+    if (lim > max_iters - iters) lim = max_iters - iters;
+    return lim;
+}
+
+/* uma caminhada de Brent com f(y) = y^2 + c, em lotes de RHO_BATCH passos:
+   entre lotes confere *stop e o orçamento, então nunca passa de max_iters
+   passos nem continua muito depois de outra thread achar um fator.
+   Retorna 1 com o fator em *factor, 0 se não achou e -1 sem memória. */
+static int rho_walk(const MontCtx *ctx, const BigInt *n, long long cval,
+                    unsigned long long max_iters, unsigned long long *iters, int *stop,
+                    BigInt **factor) {
+    *factor = NULL;
+    size_t nl = ctx->n;
+    unsigned int *buf = malloc((8 * nl + 2) * sizeof(unsigned int));
+    if (!buf) return -1;
+    unsigned int *t = buf, *cm = t + 2 * nl + 2, *x = cm + nl, *y = x + nl,
+                 *ys = y + nl, *q = ys + nl, *diff = q + nl;
+    BigInt *g = NULL;
+    int rc = 0;
+
+    mont_from_small(ctx, cm, cval, t);
+    mont_from_small(ctx, y, 2, t);
+    memcpy(q, ctx->one, nl * sizeof(unsigned int));
+
+    unsigned long long r = 1;
+    int done = (*iters >= max_iters);
+    while (!done) {
+        /* x = y; y avança r passos */
+        memcpy(x, y, nl * sizeof(unsigned int));
+        for (unsigned long long k = 0; k < r && !done;) {
+            unsigned long long lim = rho_batch(r - k, max_iters, *iters);
+            for (unsigned long long i = 0; i < lim; ++i) {
+                mont_mul(ctx, y, y, y, t);
+                mont_add(ctx, y, y, cm);
+            }
+            k += lim;
+            *iters += lim;
+            if (*iters >= max_iters || rho_stopped(stop)) done = 1;
+        }
+
+        /* mais r passos acumulando q *= (x - y), com um MDC por lote */
+        for (unsigned long long k = 0; k < r && !done;) {
+            memcpy(ys, y, nl * sizeof(unsigned int));
+            unsigned long long lim = rho_batch(r - k, max_iters, *iters);
+            for (unsigned long long i = 0; i < lim; ++i) {
+                mont_mul(ctx, y, y, y, t);
+                mont_add(ctx, y, y, cm);
+                mont_sub(ctx, diff, x, y);
+                mont_mul(ctx, q, q, diff, t);
+            }
+            k += lim;
+            *iters += lim;
+
+            g = mont_gcd(ctx, q, n);
+            if (!g) { rc = -1; break; }
+            if (!(g->len == 1 && g->data[0] == 1)) {
+                if (bigint_cmpabs(g, n) == 0) {
+                    /* passou do ponto: refaz o lote passo a passo */
+                    bigint_free(g);
+                    g = NULL;
+                    do {
+                        mont_mul(ctx, ys, ys, ys, t);
+                        mont_add(ctx, ys, ys, cm);
+                        mont_sub(ctx, diff, x, ys);
+                        bigint_free(g);
+                        g = mont_gcd(ctx, diff, n);
+                    } while (g && g->len == 1 && g->data[0] == 1);
+                    if (!g) rc = -1;
+                    else if (bigint_cmpabs(g, n) == 0) { bigint_free(g); g = NULL; }
+                }
+                if (g) { *factor = g; rc = 1; }
+                break;
+            }
+            bigint_free(g);
+            g = NULL;
+            if (*iters >= max_iters || rho_stopped(stop)) done = 1;
+        }
+        if (rc != 0) break;
+        r *= 2;
+    }
+    free(buf);
+    return rc;
+}
+
+/* caminhadas independentes em paralelo (thread i usa c = i + 1, i + 1 + T, ...);
+   cada thread gasta no máximo max_iters passos. Retorna 0 (com *factor = NULL
+   se nenhuma achou) ou -1 sem memória. */
+static int pollard_rho(const BigInt *n, unsigned long long max_iters, BigInt **factor) {
+    *factor = NULL;
+    MontCtx ctx;
+    if (mont_init(&ctx, n) != 0) return -1;
+    BigInt *found = NULL;
+    int stop = 0, oom = 0;
+
+    #pragma omp parallel
+    {
+        int tid = 0, nth = 1;
+#ifdef _OPENMP
+        tid = omp_get_thread_num();
+        nth = omp_get_num_threads();
+#endif
+        unsigned long long iters = 0;
+        for (long long cval = 1 + tid; ; cval += nth) {
+            if (rho_stopped(&stop) || iters >= max_iters) break;
+
+            BigInt *g = NULL;
+            int rc = rho_walk(&ctx, n, cval, max_iters, &iters, &stop, &g);
+            if (rc > 0) {
+                #pragma omp critical (rho_found)
+                {
+                    if (!found) { found = g; g = NULL; }
+                }
+                bigint_free(g);
+            } else if (rc < 0) {
+                #pragma omp atomic write
+                oom = 1;
+            }
+            if (rc != 0) {
+                #pragma omp atomic write
+                stop = 1;
+            }
+        }
+    }
+
+    mont_free(&ctx);
+    if (oom && !found) return -1;
+    *factor = found;
+    return 0;
+}
+
+/* ---- fatoração ---- */
+
+typedef struct {
+    BigInt **v;
+    size_t n, cap;
+} FactorList;
+
+static int factor_push(FactorList *l, BigInt *x) {
+    if (!x) return -1;
+    if (l->n == l->cap) {
+        size_t cap = l->cap ? l->cap * 2 : 16;
+        BigInt **v = realloc(l->v, cap * sizeof(BigInt *));
+        if (!v) { bigint_free(x); return -1; }
+        l->v = v;
+        l->cap = cap;
+    }
+    l->v[l->n++] = x;
+    return 0;
+}
+
+static void factor_list_free(FactorList *l) {
+    for (size_t i = 0; i < l->n; ++i) bigint_free(l->v[i]);
+    free(l->v);
+    l->v = NULL;
+    l->n = l->cap = 0;
+}
+
+static int factor_cmp(const void *x, const void *y) {
+    return bigint_cmpabs(*(BigInt *const *)x, *(BigInt *const *)y);
+}
+
+/* m sem fatores menores que TRIAL_LIMIT */
+static int factor_rec(const BigInt *m, unsigned long long iters, FactorList *primes, FactorList *comp) {
+    if (bigint_small_value(m) < (unsigned long long)TRIAL_LIMIT * TRIAL_LIMIT || bpsw(m, 0))
+        return factor_push(primes, bigint_copy(m));
+
+    BigInt *d = NULL;
+    if (pollard_rho(m, iters, &d) != 0) return -1;
+    if (!d) return factor_push(comp, bigint_copy(m));
+
+    BigInt *q = NULL;
+    compute_divmod(m, d, &q, NULL);
+    int rc = q ? factor_rec(d, iters, primes, comp) : -1;
+    if (rc == 0) rc = factor_rec(q, iters, primes, comp);
+    bigint_free(d);
+    bigint_free(q);
+    return rc;
+}
+
+int bigint_factor(const BigInt *n, unsigned long long rho_iters,
+                  BigInt ***factors, size_t *count, BigInt **rest) {
+    *factors = NULL;
+    *count = 0;
+    *rest = NULL;
+    if (!n || small_primes_init() != 0) return -1;
+
+    FactorList primes = { NULL, 0, 0 }, comp = { NULL, 0, 0 };
+    BigInt *m = bigint_abs_copy(n);
+    if (!m) return -1;
+
+    int rc = 0;
+    if (!bigint_is_zero(m)) {
+        for (size_t i = 0; i < n_small_primes && rc == 0; ++i) {
+            unsigned int p = small_primes[i];
+            if ((unsigned long long)p * p > bigint_small_value(m)) break;
+            while (rc == 0 && bigint_mod_small(m, p) == 0) {
+                bigint_div_small_inplace(m, p);
+                rc = factor_push(&primes, bigint_from_uint(p));
+            }
+        }
+        if (rc == 0 && bigint_small_value(m) != 1)
+            rc = factor_rec(m, rho_iters, &primes, &comp);
+    }
+    bigint_free(m);
+
+    /* compostos que o rho não quebrou dentro do orçamento */
+    if (rc == 0 && comp.n > 0) {
+        BigInt *r = bigint_copy(comp.v[0]);
+        for (size_t i = 1; i < comp.n && r; ++i) {
+            BigInt *t = compute_binop('*', r, comp.v[i], bigint_mul);
+            bigint_free(r);
+            r = t;
+        }
+        if (!r) rc = -1;
+        *rest = r;
+    }
+    factor_list_free(&comp);
+
+    if (rc != 0) {
+        factor_list_free(&primes);
+        bigint_free(*rest);
+        *rest = NULL;
+        return -1;
+    }
+    if (primes.n > 1) qsort(primes.v, primes.n, sizeof(BigInt *), factor_cmp);
+    *factors = primes.v;
+    *count = primes.n;
+    return 0;
+}
+
+/* ------------------ io.c (implementação embutida) ------------------ */
+
+/* lê uma linha de f em *buf (sem o '\n' final), crescendo o buffer quando
+   precisa. O buffer é reaproveitado entre chamadas (comece com *buf = NULL
+   e libere com free no final). Retorna 1 se leu, 0 em EOF sem dados ou erro. */
+static int read_line_reuse(FILE *f, char **buf, size_t *cap) {
+    if (!*buf) {
+        *cap = 4096;
+        *buf = malloc(*cap);
+        if (!*buf) return 0;
+    }
+
+    size_t len = 0;
+    (*buf)[0] = '\0';
+    for (;;) {
+        size_t room = *cap - len;
+        if (!fgets(*buf + len, room > INT_MAX ? INT_MAX : (int)room, f)) break;
+        len += strlen(*buf + len);
+        if (len && (*buf)[len-1] == '\n') break;
+        if (len + 1 >= *cap) {
+            char *nb = realloc(*buf, *cap * 2);
+            if (!nb) return 0;
+            *buf = nb;
+            *cap *= 2;
+        }
+    }
+    if (len == 0 && (feof(f) || ferror(f))) return 0;
+    if (len && (*buf)[len-1] == '\n') (*buf)[--len] = '\0';
+    if (len && (*buf)[len-1] == '\r') (*buf)[--len] = '\0';
+    return 1;
+}
+
+/* lê uma linha inteira de f, sem limite de tamanho (sem o '\n' final).
+   Retorna NULL em EOF sem dados ou falta de memória; liberar com free. */
+static char *read_line_alloc(FILE *f) {
+    char *buf = NULL;
+    size_t cap = 0;
+    if (!read_line_reuse(f, &buf, &cap)) { free(buf); return NULL; }
+    return buf;
+}
+
+BigInt *read_bigint_stdin(void) {
+    char *buf = read_line_alloc(stdin);
+    if (!buf) return NULL;
+    BigInt *r = bigint_from_string(buf);
+    free(buf);
+    return r;
+}
+
+int write_bigint_to_file(const char *path, const BigInt *res) {
+    return write_bigint_to_file_radix(path, res, 10);
+}
+
+int write_bigint_to_file_radix(const char *path, const BigInt *res, int radix) {
+    char *s = bigint_to_string_radix(res, radix);
+    if (!s) return -1;
+    FILE *f = fopen(path, "w");
+    if (!f) { free(s); return -1; }
+    fprintf(f, "%s\n", s);
+    fclose(f);
+    free(s);
+    return 0;
+}
+
+/* ------------------ main.c (embutido) ------------------ */
+
+static void print_menu(void) {
+    printf("=== CalcBigInt ===\n");
+    printf("1) Soma (+)\n");
+    printf("2) Subtracao (-)\n");
+    printf("3) Multiplicacao (*)\n");
+    printf("4) Divisao inteira (/)\n");
+    printf("5) Modulo (%%)\n");
+    printf("6) MDC\n");
+    printf("7) Sair\n");
+    printf("Escolha: ");
+}
+
+#define OP_MAX 8  /* maior token de operação + '\0' */
+
+/* S (somatório) e P (produtório) recebem uma lista de números */
+static int is_list_op(const char *op) {
+    return strcmp(op, "S") == 0 || strcmp(op, "s") == 0 ||
+           strcmp(op, "P") == 0 || strcmp(op, "p") == 0;
+}
+
+/* X: produto de matrizes; lê as dimensões e as entradas por conta própria */
+static int is_matrix_op(const char *op) {
+    return strcmp(op, "X") == 0 || strcmp(op, "x") == 0;
+}
+
+/* F: fatoração; a saída é texto ("2^3 * 5"), não um número */
+static int is_factor_op(const char *op) {
+    return strcmp(op, "F") == 0 || strcmp(op, "f") == 0;
+}
+
+/* ops sem a linha do b */
+static int is_unary_op(const char *op) {
+    return strcmp(op, "~") == 0 || strcmp(op, "?") == 0 || is_factor_op(op);
+}
+
+/* lê um registro do arquivo de entrada: 3 linhas op, a, b.
+   O arquivo pode ter vários registros seguidos (linhas em branco antes da op
+   são ignoradas); as ops unárias ~, ? e F não têm a linha do b (*b_out = NULL) e
+   S/P/X param logo após a op (*a_out = *b_out = NULL).
+   retorna o token da op em op_out (OP_MAX bytes) e BigInt* em a_out, b_out
+   (callees deve liberar).
+   retorna 1 se leu um registro, 0 no fim do arquivo, -1 em erro.
+*/
+static int read_record(FILE *f, char *op_out, BigInt **a_out, BigInt **b_out) {
+    char *line;
+    char *p;
+
+    /* linha 1: operação */
+    for (;;) {
+        line = read_line_alloc(f);
+        if (!line) return 0;
+        p = line;
+        while (*p && isspace((unsigned char)*p)) p++;
+        if (*p) break;
+        free(line);
+    }
+    size_t oplen = 0;
+    while (p[oplen] && !isspace((unsigned char)p[oplen])) oplen++;
+    if (oplen >= OP_MAX) { free(line); return -1; }
+    char op[OP_MAX];
+    memcpy(op, p, oplen);
+    op[oplen] = '\0';
+    free(line);
+
+    /* somatório/produtório/matriz: os operandos são lidos por run_list_op
+       e run_matrix_op */
+    if (is_list_op(op) || is_matrix_op(op)) {
+        strcpy(op_out, op);
+        *a_out = NULL;
+        *b_out = NULL;
+        return 1;
+    }
+
+    /* linha 2: a */
+    line = read_line_alloc(f);
+    if (!line) return -1;
+    BigInt *a = bigint_from_string(line);
+    free(line);
+    if (!a) return -1;
+
+    /* linha 3: b */
+    BigInt *b = NULL;
+    if (!is_unary_op(op)) {
+        line = read_line_alloc(f);
+        if (!line) { bigint_free(a); return -1; }
+        b = bigint_from_string(line);
+        free(line);
+        if (!b) { bigint_free(a); return -1; }
+    }
+
+    strcpy(op_out, op);
+    *a_out = a;
+    *b_out = b;
+    return 1;
+}
+
+/* S/P: um número por linha até uma linha em branco ou o fim do arquivo.
+   A soma vai direto do texto para o acumulador; o produto mantém só a
+   pilha da árvore. Em erro escreve a mensagem em stderr e retorna NULL. */
+static BigInt *run_list_op(FILE *f, const char *op) {
+    int is_sum = (op[0] == 'S' || op[0] == 's');
+    SumAcc sum;
+    ProdAcc prod;
+    memset(&sum, 0, sizeof(sum));
+    prod.n = 0;
+
+    char *line = NULL;
+    size_t cap = 0;
+    size_t count = 0;
+    int ok = 1;
+    while (ok && read_line_reuse(f, &line, &cap)) {
+        const char *p = line;
+        while (*p && isspace((unsigned char)*p)) p++;
+        if (!*p) break;
+        count++;
+        if (is_sum) {
+            ok = (sumacc_add_text(&sum, p) == 0);
+        } else {
+            BigInt *x = bigint_from_string(p);
+            ok = (x && prodacc_push(&prod, x, 0) == 0);
+        }
+    }
+    free(line);
+
+    if (!ok) {
+        fprintf(stderr, "Numero invalido na lista (item %llu).\n", (unsigned long long)count);
+        free(sum.pos.d);
+        free(sum.neg.d);
+        prodacc_free(&prod);
+        return NULL;
+    }
+
+    BigInt *res = is_sum ? sumacc_finish(&sum) : prodacc_finish(&prod);
+    if (!res) fprintf(stderr, "Erro na operacao.\n");
+    return res;
+}
+
+/* próximo token (separado por espaços) do arquivo, atravessando linhas.
+   O token aponta para dentro de *line e vale até a próxima chamada. */
+static char *next_token(FILE *f, char **line, size_t *cap, char **pos) {
+    for (;;) {
+        char *p = *pos;
+        while (p && *p && isspace((unsigned char)*p)) p++;
+        if (p && *p) {
+            char *start = p;
+            while (*p && !isspace((unsigned char)*p)) p++;
+            if (*p) *p++ = '\0';
+            *pos = p;
+            return start;
+        }
+        if (!read_line_reuse(f, line, cap)) return NULL;
+        *pos = *line;
+    }
+}
+
+/* X: linha "r k c" e depois as r*k entradas de A e as k*c de B, em ordem de
+   linha (quebras de linha livres). Retorna o texto do resultado (r linhas de
+   c números) ou NULL com a mensagem de erro em stderr. */
+static char *run_matrix_op(FILE *f, int radix) {
+    char *line = NULL, *pos = NULL;
+    size_t cap = 0;
+    unsigned long dims[3];
+    BigInt **M = NULL, **C = NULL;
+    char **cells = NULL;
+    char *out = NULL;
+    size_t r = 0, k = 0, c = 0, na = 0, nb = 0, nread = 0;
+
+    for (int d = 0; d < 3; ++d) {
+        char *tok = next_token(f, &line, &cap, &pos), *end;
+        dims[d] = tok ? strtoul(tok, &end, 10) : 0;
+        if (!tok || *end || dims[d] == 0 || dims[d] > 100000) {
+            fprintf(stderr, "Dimensoes invalidas da matriz.\n");
+            goto out;
+        }
+    }
+    r = dims[0];
+    k = dims[1];
+    c = dims[2];
+    na = r * k;
+    nb = k * c;
+
+    M = calloc(na + nb, sizeof(BigInt *));
+    if (!M) { fprintf(stderr, "Erro na operacao.\n"); goto out; }
+    for (nread = 0; nread < na + nb; ++nread) {
+        char *tok = next_token(f, &line, &cap, &pos);
+        M[nread] = tok ? bigint_from_string(tok) : NULL;
+        if (!M[nread]) {
+            fprintf(stderr, "Entrada invalida na matriz (item %llu).\n", (unsigned long long)nread + 1);
+            goto out;
+        }
+    }
+
+    C = bigint_matmul(M, M + na, r, k, c);
+    if (!C) { fprintf(stderr, "Erro na operacao.\n"); goto out; }
+
+    cells = calloc(r * c, sizeof(char *));
+    if (!cells) { fprintf(stderr, "Erro na operacao.\n"); goto out; }
+    size_t total = 1;
+    for (size_t i = 0; i < r * c; ++i) {
+        cells[i] = bigint_to_string_radix(C[i], radix);
+        if (!cells[i]) { fprintf(stderr, "Erro na operacao.\n"); goto out; }
+        total += strlen(cells[i]) + 1;
+    }
+    out = malloc(total);
+    if (!out) { fprintf(stderr, "Erro na operacao.\n"); goto out; }
+    char *p = out;
+    for (size_t i = 0; i < r * c; ++i) {
+        size_t l = strlen(cells[i]);
+        memcpy(p, cells[i], l);
+        p += l;
+        *p++ = ((i + 1) % c == 0) ? '\n' : ' ';
+    }
+    p[-1] = '\0';  /* a última quebra de linha fica por conta de quem escreve */
+
+out:
+    free(line);
+    if (M) for (size_t i = 0; i < nread && i < na + nb; ++i) bigint_free(M[i]);
+    free(M);
+    if (C) for (size_t i = 0; i < r * c; ++i) bigint_free(C[i]);
+    free(C);
+    if (cells) for (size_t i = 0; i < r * c; ++i) free(cells[i]);
+    free(cells);
+    return out;
+}
+
+static char *str_copy(const char *src) {
+    size_t l = strlen(src) + 1;
+    char *d = malloc(l);
+    if (d) memcpy(d, src, l);
+    return d;
+}
+
+/* F: "-1 * 2^3 * 5 * 7^2"; compostos que o rho não quebrou saem entre
+   parênteses (com aviso em stderr). Retorna o texto ou NULL com a mensagem
+   de erro em stderr. */
+static char *run_factor_op(const BigInt *a, int radix, unsigned long long rho_iters) {
+    if (bigint_is_zero(a)) return bigint_to_string_radix(a, radix);
+
+    BigInt **fs = NULL, *rest = NULL;
+    size_t nf = 0;
+    if (bigint_factor(a, rho_iters, &fs, &nf, &rest) != 0) {
+        fprintf(stderr, "Erro na fatoracao.\n");
+        return NULL;
+    }
+
+    char *out = NULL, *rs = NULL;
+    size_t len = 0, cap = 64;
+    int ok = 1;
+    char **parts = calloc(nf + 2, sizeof(char *));
+    size_t np = 0;
+    if (!parts) ok = 0;
+
+    /* agrupa primos iguais (já vêm ordenados) em p^e */
+    if (ok && a->sign < 0) ok = (parts[np++] = str_copy("-1")) != NULL;
+    for (size_t i = 0; ok && i < nf; ) {
+        size_t j = i;
+        while (j < nf && bigint_cmpabs(fs[i], fs[j]) == 0) j++;
+        char *ps = bigint_to_string_radix(fs[i], radix);
+        if (!ps) { ok = 0; break; }
+        if (j - i > 1) {
+            char *t = malloc(strlen(ps) + 24);
+            if (t) sprintf(t, "%s^%llu", ps, (unsigned long long)(j - i));
+            free(ps);
+            ps = t;
+        }
+        ok = (parts[np++] = ps) != NULL;
+        i = j;
+    }
+    if (ok && rest) {
+        fprintf(stderr, "Aviso: fator composto nao quebrado (aumente --rho-iters).\n");
+        rs = bigint_to_string_radix(rest, radix);
+        char *t = rs ? malloc(strlen(rs) + 3) : NULL;
+        if (t) sprintf(t, "(%s)", rs);
+        ok = (parts[np++] = t) != NULL;
+    }
+    if (ok && np == 0) ok = (parts[np++] = str_copy("1")) != NULL;  /* |a| = 1 */
+
+    if (ok) {
+        for (size_t i = 0; i < np; ++i) len += strlen(parts[i]) + 3;
+        if (len + 1 > cap) cap = len + 1;
+        out = malloc(cap);
+        ok = out != NULL;
+    }
+    if (ok) {
+        char *p = out;
+        for (size_t i = 0; i < np; ++i) {
+            if (i) { memcpy(p, " * ", 3); p += 3; }
+            size_t l = strlen(parts[i]);
+            memcpy(p, parts[i], l);
+            p += l;
+        }
+        *p = '\0';
+    } else {
+        fprintf(stderr, "Erro na operacao.\n");
+    }
+
+    if (parts) for (size_t i = 0; i < np; ++i) free(parts[i]);
+    free(parts);
+    free(rs);
+    for (size_t i = 0; i < nf; ++i) bigint_free(fs[i]);
+    free(fs);
+    bigint_free(rest);
+    return out;
+}
+
+/* executa uma op do modo arquivo; em erro escreve a mensagem em stderr e
+   retorna NULL */
+static BigInt *run_file_op(const char *op, const BigInt *a, const BigInt *b) {
+    BigInt *res = NULL;
+    if (strcmp(op, "+") == 0) {
+        res = bigint_add_cached(a, b);
+    } else if (strcmp(op, "-") == 0) {
+        res = bigint_sub_cached(a, b);
+    } else if (strcmp(op, "*") == 0) {
+        res = bigint_mul_cached(a, b);
+    } else if (strcmp(op, "&") == 0) {
+        res = bigint_and(a, b);
+    } else if (strcmp(op, "|") == 0) {
+        res = bigint_or(a, b);
+    } else if (strcmp(op, "^") == 0) {
+        res = bigint_xor(a, b);
+    } else if (strcmp(op, "~") == 0) {
+        res = bigint_not(a);
+    } else if (strcmp(op, "?") == 0) {
+        res = bigint_from_uint(bigint_is_prime(a, PRIME_EXTRA_ROUNDS) ? 1u : 0u);
+    } else if (strcmp(op, "<<") == 0 || strcmp(op, ">>") == 0) {
+        size_t k;
+        if (bigint_to_size(b, &k) != 0) {
+            fprintf(stderr, "Deslocamento invalido (precisa ser >= 0).\n");
+            return NULL;
+        }
+        res = (op[0] == '<') ? bigint_shl(a, k) : bigint_shr(a, k);
+    } else if (strcmp(op, "/") == 0) {
+        /* para '/' escrevemos apenas o quociente */
+        bigint_divmod_cached(a, b, &res, NULL);
+        if (!res) fprintf(stderr, "Erro na divisao (divisor zero?).\n");
+        return res;
+    } else if (strcmp(op, "%") == 0) {
+        /* para '%' escrevemos apenas o resto */
+        bigint_divmod_cached(a, b, NULL, &res);
+        if (!res) fprintf(stderr, "Erro na operacao modulo (divisor zero?).\n");
+        return res;
+    } else if (strcmp(op, "m") == 0 || strcmp(op, "M") == 0) {
+        res = bigint_gcd_cached(a, b);
+        if (!res) fprintf(stderr, "Erro calculando MDC.\n");
+        return res;
+    } else {
+        fprintf(stderr, "Operacao desconhecida: %s\n", op);
+        return NULL;
+    }
+
+    if (!res) fprintf(stderr, "Erro na operacao.\n");
+    return res;
+}
+
+static void print_cache_stats(void) {
+    unsigned long long hits, misses;
+    size_t bytes;
+    bigint_cache_stats(&hits, &misses, &bytes);
+    fprintf(stderr, "Cache: %llu acertos, %llu falhas, %llu bytes em uso\n",
+            hits, misses, (unsigned long long)bytes);
+}
+
+int main(int argc, char **argv) {
+    char line[64];
+    int out_radix = 10;
+    int show_cache_stats = 0;
+    int cache_on = 1;
+    size_t cache_budget = 0;  /* 0 = padrão */
+    unsigned long long rho_iters = RHO_DEFAULT_ITERS;
+    const char *inputfile = NULL;
+
+    /* flags de base de saída (--hex, --oct, --bin, --dec), do cache
+       (--no-cache, --cache-mb=N, --cache-stats) e do orçamento do Pollard-rho
+       (--rho-iters=N); o primeiro argumento que
+       não é flag é o arquivo de entrada */
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--hex") == 0) out_radix = 16;
+        else if (strcmp(argv[i], "--oct") == 0) out_radix = 8;
+        else if (strcmp(argv[i], "--bin") == 0) out_radix = 2;
+        else if (strcmp(argv[i], "--dec") == 0) out_radix = 10;
+        else if (strcmp(argv[i], "--no-cache") == 0) cache_on = 0;
+        else if (strcmp(argv[i], "--cache-stats") == 0) show_cache_stats = 1;
+        else if (strncmp(argv[i], "--cache-mb=", 11) == 0) {
+            char *end;
+            unsigned long mb = strtoul(argv[i] + 11, &end, 10);
+            if (*end || mb == 0) {
+                fprintf(stderr, "Valor invalido em %s\n", argv[i]);
+                return 1;
+            }
+            cache_budget = (size_t)mb * 1024u * 1024u;
+        } else if (strncmp(argv[i], "--rho-iters=", 12) == 0) {
+            char *end;
+            rho_iters = strtoull(argv[i] + 12, &end, 10);
+            if (*end || rho_iters == 0) {
+                fprintf(stderr, "Valor invalido em %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--", 2) == 0) {
+            fprintf(stderr, "Opcao desconhecida: %s\n", argv[i]);
+            return 1;
+        } else if (!inputfile) {
+            inputfile = argv[i];
+        } else {
+            fprintf(stderr, "Argumento extra: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    /* configurado uma vez só, depois de todas as flags: --no-cache vence
+       --cache-mb=N em qualquer ordem */
+    bigint_cache_config(cache_on, cache_budget);
+
+    /* comportamento: com arquivo de entrada -> modo arquivo. escreve "resultado.txt",
+       um resultado por linha na ordem dos registros */
+    if (inputfile) {
+        const char *outputfile = "resultado.txt";
+
+        FILE *in = fopen(inputfile, "r");
+        if (!in) {
+            fprintf(stderr, "Erro lendo arquivo de entrada (%s)\n", inputfile);
+            return 1;
+        }
+
+        FILE *out = NULL;   /* só criado quando o primeiro resultado sai */
+        char op[OP_MAX];
+        BigInt *a = NULL, *b = NULL;
+        int rc, nrec = 0, status = 0;
+        while ((rc = read_record(in, op, &a, &b)) > 0) {
+            char *s = NULL;
+            if (is_matrix_op(op)) {
+                s = run_matrix_op(in, out_radix);
+                if (!s) { status = 1; break; }
+            } else if (is_factor_op(op)) {
+                s = run_factor_op(a, out_radix, rho_iters);
+                bigint_free(a);
+                if (!s) { status = 1; break; }
+            } else {
+                BigInt *res = is_list_op(op) ? run_list_op(in, op) : run_file_op(op, a, b);
+                bigint_free(a); bigint_free(b);
+                if (!res) { status = 1; break; }
+                s = bigint_to_string_radix(res, out_radix);
+                bigint_free(res);
+            }
+            if (!out) out = fopen(outputfile, "w");
+            if (!s || !out || fprintf(out, "%s\n", s) < 0) {
+                fprintf(stderr, "Erro escrevendo resultado em %s\n", outputfile);
+                free(s);
+                status = 1;
+                break;
+            }
+            free(s);
+            nrec++;
+        }
+        if (status == 0 && (rc < 0 || nrec == 0)) {
+            fprintf(stderr, "Erro lendo arquivo de entrada (%s)\n", inputfile);
+            status = 1;
+        }
+        fclose(in);
+        if (out && fclose(out) != 0 && status == 0) {
+            fprintf(stderr, "Erro escrevendo resultado em %s\n", outputfile);
+            status = 1;
         }
-        printf("Resultado escrito em %s\n", outputfile);
-        bigint_free(res); bigint_free(a); bigint_free(b);
-        return 0;
+        if (status == 0) printf("Resultado escrito em %s\n", outputfile);
+        if (show_cache_stats) print_cache_stats();
+        return status;
     }
 
     /* modo interativo */
@@ -669,14 +3201,14 @@ int main(int argc, char **argv) {
 
         if (opnum == 1 || opnum == 2 || opnum == 3) {
             BigInt *res = NULL;
-            if (opnum == 1) res = bigint_add(a, b);
-            else if (opnum == 2) res = bigint_sub(a, b);
-            else if (opnum == 3) res = bigint_mul(a, b);
+            if (opnum == 1) res = bigint_add_cached(a, b);
+            else if (opnum == 2) res = bigint_sub_cached(a, b);
+            else if (opnum == 3) res = bigint_mul_cached(a, b);
 
             if (!res) {
                 printf("Erro na operacao.\n");
             } else {
-                char *s = bigint_to_string(res);
+                char *s = bigint_to_string_radix(res, out_radix);
                 if (s) {
                     printf("Resultado: %s\n", s);
                     free(s);
@@ -687,11 +3219,11 @@ int main(int argc, char **argv) {
             /* Divisao inteira: mostrar apenas quociente */
             BigInt *q = NULL;
             BigInt *r = NULL;
-            bigint_divmod(a, b, &q, &r);
+            bigint_divmod_cached(a, b, &q, &r);
             if (!q) {
                 printf("Erro na divisao (divisor zero?).\n");
             } else {
-                char *sq = bigint_to_string(q);
+                char *sq = bigint_to_string_radix(q, out_radix);
                 if (sq) { printf("%s\n", sq); free(sq); }
             }
             if (q) bigint_free(q);
@@ -700,22 +3232,22 @@ int main(int argc, char **argv) {
             /* Modulo: mostrar apenas resto */
             BigInt *q = NULL;
             BigInt *r = NULL;
-            bigint_divmod(a, b, &q, &r);
+            bigint_divmod_cached(a, b, &q, &r);
             if (!r) {
                 printf("Erro na operacao modulo (divisor zero?).\n");
             } else {
-                char *sr = bigint_to_string(r);
+                char *sr = bigint_to_string_radix(r, out_radix);
                 if (sr) { printf("%s\n", sr); free(sr); }
             }
             if (q) bigint_free(q);
             if (r) bigint_free(r);
         } else if (opnum == 6) {
             /* MDC */
-            BigInt *g = bigint_gcd(a, b);
+            BigInt *g = bigint_gcd_cached(a, b);
             if (!g) {
                 printf("Erro calculando MDC.\n");
             } else {
-                char *sg = bigint_to_string(g);
+                char *sg = bigint_to_string_radix(g, out_radix);
                 if (sg) { printf("%s\n", sg); free(sg); }
                 bigint_free(g);
             }
@@ -727,5 +3259,6 @@ int main(int argc, char **argv) {
         printf("\n");
     }
 
+    if (show_cache_stats) print_cache_stats();
     return 0;
 }
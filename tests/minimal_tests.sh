@@ -7,3 +7,5 @@ if [ -x bin/calcbigint ]; then
 else
   echo "ERROR: build failed"
 fi
+# testes diferenciais (largura fixa, matrizes, primalidade e fatoração)
+make test
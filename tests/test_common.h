@@ -0,0 +1,55 @@
+/* Infra comum dos testes (make test): inclui src/main.c direto, para que as
+   funções static fiquem visíveis, e dá um gerador xorshift determinístico e
+   o contador de falhas. Cada teste define TEST_SEED antes do include se
+   quiser outra sequência. */
+
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+
+#define main calcbigint_main
+#include "../src/main.c"
+#undef main
+
+#include <stdarg.h>
+
+#ifndef TEST_SEED
+#define TEST_SEED 88172645463325252ull
+#endif
+
+static unsigned long long rng_state = TEST_SEED;
+
+static unsigned long long rnd(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static int failures = 0;
+
+/* mesmo valor e mesmo sinal (NULL nunca confere) */
+static int same(const BigInt *x, const BigInt *y) {
+    return x && y && bigint_cmpabs(x, y) == 0 && x->sign == y->sign;
+}
+
+/* registra uma falha: "FALHA " + mensagem em stderr */
+static void fail(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    fputs("FALHA ", stderr);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+    failures++;
+}
+
+/* sem memória num teste não é falha do código testado: aborta */
+static void *test_check_alloc(void *p) {
+    if (!p) {
+        fprintf(stderr, "sem memoria\n");
+        exit(2);
+    }
+    return p;
+}
+
+#endif
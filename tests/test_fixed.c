@@ -0,0 +1,124 @@
+/* Teste diferencial dos tipos de largura fixa (fixed.c): para cada largura,
+   pares aleatórios e casos de borda passam por bigint_fixed_try e pelas
+   rotinas genéricas (bigint_add, bigint_mul, bigint_divmod, bigint_gcd),
+   e os resultados têm que ser idênticos. */
+
+#include "test_common.h"
+
+#define ITERS_PER_WIDTH 2000
+
+/* número com até maxl blocos; os modos geram blocos cheios (BASE - 1),
+   alternância 0 / BASE - 1 e topo grande com o resto quase zero, que são
+   os casos que exercitam carry, empréstimo e a normalização do algoritmo D */
+static BigInt *gen(size_t maxl) {
+    size_t l = 1 + (size_t)(rnd() % maxl);
+    BigInt *r = bigint_new(l, (rnd() & 1) ? 1 : -1);
+    if (!r) return NULL;
+    int mode = (int)(rnd() % 4);
+    for (size_t i = 0; i < l; ++i) {
+        unsigned int v = (unsigned int)(rnd() % BASE);
+        if (mode == 1) v = BASE - 1 - (unsigned int)(rnd() % 3);
+        if (mode == 2) v = (rnd() & 1) ? 0 : BASE - 1;
+        if (mode == 3 && i + 1 < l) v = (unsigned int)(rnd() % 2);
+        r->data[i] = v;
+    }
+    bigint_normalize(r);
+    return r;
+}
+
+static void report(const char *what, char op, const BigInt *a, const BigInt *b) {
+    char *sa = bigint_to_string(a), *sb = bigint_to_string(b);
+    fail("%s '%c'\n  a = %s\n  b = %s", what, op, sa ? sa : "?", sb ? sb : "?");
+    free(sa);
+    free(sb);
+}
+
+/* confere as quatro ops do caminho fixo contra o genérico para (a, b) */
+static void check_pair(const BigInt *a, const BigInt *b) {
+    BigInt *f1 = NULL, *f2 = NULL, *g1 = NULL, *g2 = NULL;
+
+    if (bigint_fixed_try('+', a, b, &f1, NULL) == 0) {
+        g1 = bigint_add(a, b);
+        if (!same(f1, g1)) report("soma", '+', a, b);
+        bigint_free(f1); bigint_free(g1);
+        f1 = g1 = NULL;
+    }
+
+    if (bigint_fixed_try('*', a, b, &f1, NULL) == 0) {
+        g1 = bigint_mul(a, b);
+        if (!same(f1, g1)) report("produto", '*', a, b);
+        bigint_free(f1); bigint_free(g1);
+        f1 = g1 = NULL;
+    }
+
+    if (!bigint_is_zero(b) && bigint_fixed_try('/', a, b, &f1, &f2) == 0) {
+        bigint_divmod(a, b, &g1, &g2);
+        if (!same(f1, g1) || !same(f2, g2)) report("divmod", '/', a, b);
+        bigint_free(f1); bigint_free(f2); bigint_free(g1); bigint_free(g2);
+        f1 = f2 = g1 = g2 = NULL;
+    }
+
+    if (bigint_fixed_try('m', a, b, &f1, NULL) == 0) {
+        g1 = bigint_gcd(a, b);
+        if (!same(f1, g1)) report("mdc", 'm', a, b);
+        bigint_free(f1); bigint_free(g1);
+    }
+}
+
+/* u = q * v - 1 com v já normalizado (topo >= BASE/2) e bloco baixo != 0:
+   o -1 fica só no bloco mais baixo, a estimativa de qhat pelos blocos do
+   topo acerta q e o passo de "soma de volta" do algoritmo D é obrigatório.
+   Com operandos aleatórios esse passo tem chance ~2/BASE e nunca roda. */
+static void check_addback(size_t width) {
+    size_t nv = 2 + (size_t)(rnd() % (width - 2));
+    size_t nq = 1 + (size_t)(rnd() % (width - nv));
+    BigInt *v = test_check_alloc(gen(nv)), *q = test_check_alloc(gen(nq));
+    BigInt *one = test_check_alloc(bigint_from_uint(1));
+    v->sign = q->sign = 1;
+    if (v->len < nv) {
+        bigint_free(v);
+        v = test_check_alloc(bigint_new(nv, 1));
+        memset(v->data, 0, nv * sizeof(unsigned int));
+    }
+    v->data[nv - 1] = BASE / 2 + (unsigned int)(rnd() % (BASE / 2));
+    v->data[0] |= 1;
+    BigInt *qv = bigint_mul(q, v);
+    BigInt *u = test_check_alloc(qv ? bigint_sub(qv, one) : NULL);
+    if (u->len <= width) check_pair(u, v);
+    bigint_free(v); bigint_free(q); bigint_free(one); bigint_free(qv); bigint_free(u);
+}
+
+/* divisor zero: o caminho fixo tem que tratar (retorna 0) sem resultado */
+static void check_zero_divisor(size_t maxl) {
+    BigInt *a = gen(maxl), *z = bigint_from_uint(0);
+    BigInt *q = NULL, *r = NULL;
+    if (!a || !z || bigint_fixed_try('/', a, z, &q, &r) != 0 || q || r)
+        fail("divisor zero (%zu blocos)", maxl);
+    bigint_free(a);
+    bigint_free(z);
+}
+
+int main(void) {
+    static const size_t widths[] = { 9, 18, 35, 69 };
+    long pairs = 0;
+
+    for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); ++w) {
+        size_t n = widths[w];
+        for (int it = 0; it < ITERS_PER_WIDTH; ++it) {
+            /* divisores curtos e longos: o algoritmo D tem casos para ambos */
+            BigInt *a = test_check_alloc(gen(n));
+            BigInt *b = test_check_alloc(gen((rnd() & 1) ? n : 1 + (size_t)(rnd() % 3)));
+            check_pair(a, b);
+            check_pair(b, a);
+            check_pair(a, a);
+            bigint_free(a);
+            bigint_free(b);
+            check_addback(n);
+            pairs += 4;
+        }
+        check_zero_divisor(n);
+    }
+
+    printf("test_fixed: %ld pares, %d falhas\n", pairs, failures);
+    return failures ? 1 : 0;
+}
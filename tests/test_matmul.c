@@ -0,0 +1,68 @@
+/* Teste diferencial de bigint_matmul (matrix.c): cada célula é comparada
+   com o produto escalar ingênuo (bigint_mul + bigint_add), com entradas
+   abaixo e acima de MATMUL_NTT_MIN_LIMBS, para cobrir tanto o caminho
+   escolar quanto o NTT/CRT, inclusive com sinais misturados. */
+
+#define TEST_SEED 1234567ull
+#include "test_common.h"
+
+/* len blocos (às vezes um a menos), sinal aleatório e blocos BASE - 1
+   frequentes, para forçar coeficientes grandes na CRT */
+static BigInt *gen(size_t len) {
+    BigInt *r = test_check_alloc(bigint_new(len, (rnd() % 3) ? 1 : -1));
+    for (size_t i = 0; i < len; ++i)
+        r->data[i] = (rnd() % 5 == 0) ? BASE - 1 : (unsigned int)(rnd() % BASE);
+    if (rnd() % 10 == 0) r->data[len - 1] = 0;
+    bigint_normalize(r);
+    return r;
+}
+
+/* A (r x k) com entradas de la blocos, B (k x c) com entradas de lb blocos */
+static void check_case(size_t r, size_t k, size_t c, size_t la, size_t lb) {
+    BigInt **A = test_check_alloc(calloc(r * k, sizeof(BigInt *)));
+    BigInt **B = test_check_alloc(calloc(k * c, sizeof(BigInt *)));
+    for (size_t i = 0; i < r * k; ++i) A[i] = gen(la);
+    for (size_t i = 0; i < k * c; ++i) B[i] = gen(lb);
+
+    BigInt **C = bigint_matmul(A, B, r, k, c);
+    int bad = (C == NULL);
+    for (size_t i = 0; i < r && !bad; ++i) {
+        for (size_t j = 0; j < c && !bad; ++j) {
+            BigInt *acc = bigint_from_uint(0);
+            for (size_t t = 0; t < k; ++t) {
+                BigInt *p = bigint_mul(A[i * k + t], B[t * c + j]);
+                BigInt *s = bigint_add(acc, p);
+                bigint_free(acc);
+                bigint_free(p);
+                acc = s;
+            }
+            if (!same(acc, C[i * c + j])) bad = 1;
+            bigint_free(acc);
+        }
+    }
+
+    if (bad) fail("%zux%zux%zu, blocos %zu / %zu", r, k, c, la, lb);
+
+    if (C) for (size_t i = 0; i < r * c; ++i) bigint_free(C[i]);
+    free(C);
+    for (size_t i = 0; i < r * k; ++i) bigint_free(A[i]);
+    for (size_t i = 0; i < k * c; ++i) bigint_free(B[i]);
+    free(A);
+    free(B);
+}
+
+int main(void) {
+    /* escolar */
+    check_case(1, 1, 1, 1, 1);
+    check_case(4, 3, 5, 7, 11);
+    check_case(3, 8, 3, 150, 191);
+    /* logo abaixo e logo acima do limiar do NTT */
+    check_case(3, 4, 3, MATMUL_NTT_MIN_LIMBS - 1, MATMUL_NTT_MIN_LIMBS + 40);
+    check_case(3, 4, 3, MATMUL_NTT_MIN_LIMBS, MATMUL_NTT_MIN_LIMBS);
+    /* NTT com tamanhos diferentes e k maior (coeficientes maiores na CRT) */
+    check_case(2, 16, 2, 300, 700);
+    check_case(5, 2, 1, 1000, 200);
+
+    printf("test_matmul: %d falhas\n", failures);
+    return failures ? 1 : 0;
+}
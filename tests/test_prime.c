@@ -0,0 +1,229 @@
+/* Teste de prime.c: primos e compostos conhecidos em bigint_is_prime,
+   pseudoprimos fortes de base 2 (pegos pelo Lucas) e de Lucas (pegos pelo
+   Miller–Rabin), quadrados de primos (o Lucas tem que terminar), mont_mul
+   contra bigint_mul + bigint_divmod e a fatoração conferida pelo produto. */
+
+#define TEST_SEED 2463534242ull
+#include "test_common.h"
+
+#define MONT_ITERS 200
+#define FACTOR_ITERS 60
+
+static BigInt *num(const char *s) {
+    return test_check_alloc(bigint_from_string(s));
+}
+
+/* 2^k - 1 */
+static BigInt *mersenne(size_t k) {
+    BigInt *one = test_check_alloc(bigint_from_uint(1));
+    BigInt *p = test_check_alloc(bigint_shl(one, k));
+    BigInt *m = test_check_alloc(bigint_sub(p, one));
+    bigint_free(one);
+    bigint_free(p);
+    return m;
+}
+
+static void expect_prime(const char *name, BigInt *n, int want) {
+    int got = bigint_is_prime(n, PRIME_EXTRA_ROUNDS);
+    if (got != want) fail("bigint_is_prime(%s) = %d, esperado %d", name, got, want);
+    bigint_free(n);
+}
+
+/* Miller–Rabin forte só na base 2 (o primeiro passo do bpsw) */
+static int mr_base2(const BigInt *n) {
+    MontCtx c;
+    if (mont_init(&c, n) != 0) return -1;
+    size_t nl = c.n, nd = 0;
+    unsigned int *d = test_check_alloc(bigint_to_words(n, &nd));
+    unsigned int *buf = test_check_alloc(malloc((5 * nl + 2) * sizeof(unsigned int)));
+    unsigned int *t = buf, *x = t + 2 * nl + 2, *base = x + nl, *minus_one = base + nl;
+    unsigned int s;
+    d[0] -= 1;
+    words_strip_twos(d, &nd, &s);
+    memset(minus_one, 0, nl * sizeof(unsigned int));
+    mont_sub(&c, minus_one, minus_one, c.one);
+    mont_from_small(&c, base, 2, t);
+    int res = mr_round(&c, base, d, nd, s, x, minus_one, t);
+    free(buf);
+    free(d);
+    mont_free(&c);
+    return res;
+}
+
+static int lucas(const BigInt *n) {
+    MontCtx c;
+    if (mont_init(&c, n) != 0) return -1;
+    unsigned int *t = test_check_alloc(malloc((2 * c.n + 2) * sizeof(unsigned int)));
+    int res = strong_lucas(&c, n, t);
+    free(t);
+    mont_free(&c);
+    return res;
+}
+
+/* passam no MR base 2; o Lucas (e portanto o BPSW) tem que recusar */
+static void check_strong_psp2(const char *s) {
+    BigInt *n = num(s);
+    if (mr_base2(n) != 1) fail("%s deveria passar no MR base 2", s);
+    if (bpsw(n, 0) != 0) fail("bpsw(%s) aceitou pseudoprimo de base 2", s);
+    expect_prime(s, n, 0);
+}
+
+/* pseudoprimos fortes de Lucas (Selfridge): o MR base 2 tem que recusar */
+static void check_lucas_psp(const char *s) {
+    BigInt *n = num(s);
+    if (lucas(n) != 1) fail("%s deveria passar no Lucas forte", s);
+    if (bpsw(n, 0) != 0) fail("bpsw(%s) aceitou pseudoprimo de Lucas", s);
+    expect_prime(s, n, 0);
+}
+
+/* p^2 com p > 2^20: não é primo e o Lucas termina (sem D com (D/n) = -1) */
+static void check_square(const char *p_str, int factor_it) {
+    BigInt *p = num(p_str);
+    BigInt *n = test_check_alloc(bigint_mul(p, p));
+    if (lucas(n) != 0) fail("Lucas forte aceitou %s^2", p_str);
+    if (bigint_is_prime(n, PRIME_EXTRA_ROUNDS) != 0) fail("%s^2 dado como primo", p_str);
+
+    if (factor_it) {
+        BigInt **fs = NULL, *rest = NULL;
+        size_t nf = 0;
+        if (bigint_factor(n, RHO_DEFAULT_ITERS, &fs, &nf, &rest) != 0 || nf != 2 || rest ||
+            !same(fs[0], p) || !same(fs[1], p))
+            fail("fatoracao de %s^2", p_str);
+        for (size_t i = 0; i < nf; ++i) bigint_free(fs[i]);
+        free(fs);
+        bigint_free(rest);
+    }
+    bigint_free(p);
+    bigint_free(n);
+}
+
+/* mont_mul(a, b) * R = a * b (mod m), com R mod m = c.one */
+static void check_mont_mul(size_t len) {
+    BigInt *m = test_check_alloc(bigint_new(len, 1));
+    for (size_t i = 0; i < len; ++i) m->data[i] = (unsigned int)(rnd() % BASE);
+    m->data[len - 1] |= 1;                      /* len blocos de verdade */
+    m->data[0] = (m->data[0] / 10) * 10 + 7;    /* primo com 10 */
+
+    MontCtx c;
+    if (mont_init(&c, m) != 0) { fail("mont_init (%zu blocos)", len); bigint_free(m); return; }
+    size_t nl = c.n;
+    unsigned int *buf = test_check_alloc(calloc(5 * nl + 2, sizeof(unsigned int)));
+    unsigned int *t = buf, *xa = t + nl + 2, *xb = xa + nl, *xo = xb + nl;
+
+    BigInt *ab = NULL, *one = test_check_alloc(bigint_from_limbs(c.one, nl, 1));
+    BigInt *x[2];
+    for (int k = 0; k < 2; ++k) {
+        BigInt *r = test_check_alloc(bigint_new(len, 1));
+        for (size_t i = 0; i < len; ++i) r->data[i] = (unsigned int)(rnd() % BASE);
+        bigint_normalize(r);
+        bigint_divmod(r, m, NULL, &x[k]);
+        test_check_alloc(x[k]);
+        bigint_free(r);
+        memcpy(k ? xb : xa, x[k]->data, x[k]->len * sizeof(unsigned int));
+    }
+
+    mont_mul(&c, xo, xa, xb, t);
+    BigInt *got = test_check_alloc(bigint_from_limbs(xo, nl, 1));
+    BigInt *gotR = test_check_alloc(bigint_mul(got, one));
+    BigInt *lhs = NULL, *rhs = NULL;
+    bigint_divmod(gotR, m, NULL, &lhs);
+    ab = test_check_alloc(bigint_mul(x[0], x[1]));
+    bigint_divmod(ab, m, NULL, &rhs);
+    if (!same(lhs, rhs) || bigint_cmpabs(got, m) >= 0) fail("mont_mul (%zu blocos)", len);
+
+    bigint_free(lhs); bigint_free(rhs); bigint_free(ab); bigint_free(got); bigint_free(gotR);
+    bigint_free(one); bigint_free(x[0]); bigint_free(x[1]); bigint_free(m);
+    free(buf);
+    mont_free(&c);
+}
+
+/* fatores primos, em ordem, e produto (vezes o resto não quebrado) = |n| */
+static void check_factor(BigInt *n) {
+    BigInt **fs = NULL, *rest = NULL;
+    size_t nf = 0;
+    char *sn = bigint_to_string(n);
+    if (bigint_factor(n, RHO_DEFAULT_ITERS, &fs, &nf, &rest) != 0) {
+        fail("bigint_factor(%s) falhou", sn ? sn : "?");
+        free(sn);
+        bigint_free(n);
+        return;
+    }
+
+    BigInt *prod = test_check_alloc(rest ? bigint_copy(rest) : bigint_from_uint(1));
+    for (size_t i = 0; i < nf; ++i) {
+        if (!bigint_is_prime(fs[i], PRIME_EXTRA_ROUNDS)) fail("fator composto em %s", sn ? sn : "?");
+        if (i > 0 && bigint_cmpabs(fs[i - 1], fs[i]) > 0) fail("fatores fora de ordem em %s", sn ? sn : "?");
+        BigInt *t = test_check_alloc(bigint_mul(prod, fs[i]));
+        bigint_free(prod);
+        prod = t;
+    }
+    BigInt *absn = test_check_alloc(bigint_abs_copy(n));
+    if (!same(prod, absn)) fail("produto dos fatores != %s", sn ? sn : "?");
+
+    for (size_t i = 0; i < nf; ++i) bigint_free(fs[i]);
+    free(fs);
+    bigint_free(rest);
+    bigint_free(prod);
+    bigint_free(absn);
+    bigint_free(n);
+    free(sn);
+}
+
+/* inteiro aleatório de até 64 bits (maior fator composto cabe no rho) */
+static BigInt *rand_u64(void) {
+    char s[32];
+    snprintf(s, sizeof(s), "%llu", rnd() >> (rnd() % 60));
+    return num(s);
+}
+
+int main(void) {
+    /* primos conhecidos */
+    expect_prime("2", num("2"), 1);
+    expect_prime("3", num("3"), 1);
+    expect_prime("1000000007", num("1000000007"), 1);
+    expect_prime("2^61-1", mersenne(61), 1);
+    expect_prime("2^89-1", mersenne(89), 1);
+    expect_prime("2^127-1", mersenne(127), 1);
+    expect_prime("2^521-1", mersenne(521), 1);
+    expect_prime("2^607-1", mersenne(607), 1);
+
+    /* compostos e não-primos */
+    expect_prime("0", num("0"), 0);
+    expect_prime("1", num("1"), 0);
+    expect_prime("-7", num("-7"), 0);
+    expect_prime("561", num("561"), 0);
+    expect_prime("2^67-1", mersenne(67), 0);
+    expect_prime("2^257-1", mersenne(257), 0);
+
+    check_strong_psp2("2047");
+    check_strong_psp2("3215031751");
+    check_strong_psp2("3825123056546413051");
+
+    check_lucas_psp("5459");
+    check_lucas_psp("5777");
+    check_lucas_psp("10877");
+
+    check_square("1048583", 1);
+    check_square("1000000007", 1);
+    check_square("2305843009213693951", 0);  /* (2^61-1)^2: rho não chega em p */
+    check_square("170141183460469231731687303715884105727", 0);
+
+    static const size_t mont_lens[] = { 1, 2, 3, 9, 35, 70, 120 };
+    for (size_t i = 0; i < sizeof(mont_lens) / sizeof(mont_lens[0]); ++i)
+        for (int it = 0; it < MONT_ITERS; ++it) check_mont_mul(mont_lens[i]);
+
+    check_factor(num("-360"));
+    check_factor(num("1"));
+    check_factor(num("18446744073709551617"));  /* 2^64 + 1 */
+    check_factor(mersenne(67));
+    check_factor(num("1000000016000000063"));   /* 1000000007 * 1000000009 */
+    for (int it = 0; it < FACTOR_ITERS; ++it) {
+        BigInt *a = rand_u64(), *b = rand_u64();
+        check_factor(test_check_alloc(bigint_mul(a, b)));
+        bigint_free(a);
+        bigint_free(b);
+    }
+
+    printf("test_prime: %d falhas\n", failures);
+    return failures ? 1 : 0;
+}